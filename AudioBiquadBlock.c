@@ -0,0 +1,194 @@
+/*
+**
+** Copyright 2009, The Android Open Source Project
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include <string.h>
+#include <assert.h>
+#include "AudioBiquadBlock.h"
+#include "AudioBiquadCascade.h"
+#include "AudioSimd.h"
+
+#define K  BIQUAD_BLOCK_SIZE
+
+// Multiplies a block by the matrix of a section, in place. x holds the inputs
+// on entry and the outputs on return, d the delays.
+static void block_section(const audio_coef_float_t m[][K], audio_sample_float_t x[K],
+	audio_sample_float_t d[4]) {
+
+	int i = 0;
+	int j = 0;
+	audio_sample_float_t y[K];
+    for (i = 0; i < K; ++i) {
+        y[i] = m[K][i] * d[0] + m[K + 1][i] * d[1] + m[K + 2][i] * d[2] + m[K + 3][i] * d[3];
+    }
+    for (j = 0; j < K; ++j) {
+        for (i = j; i < K; ++i) {
+            y[i] += m[j][i] * x[j];
+        }
+    }
+    d[0] = x[K - 1];
+    d[1] = x[K - 2];
+    d[2] = y[K - 1];
+    d[3] = y[K - 2];
+    memcpy(x, y, sizeof(y));
+}
+
+static void block_process(const audio_coef_float_t (* const matrices[])[K],
+	audio_sample_float_t delays[][MAX_CHANNELS][4], int numSections, int ch,
+	const audio_sample_float_t *in, audio_sample_float_t *out, int numBlocks, int stride) {
+
+	int i = 0;
+	int s = 0;
+	audio_sample_float_t x[K];
+    while (numBlocks-- > 0) {
+        for (i = 0; i < K; ++i) {
+            x[i] = in[i * stride];
+        }
+        for (s = 0; s < numSections; ++s) {
+            block_section(matrices[s], x, delays[s][ch]);
+        }
+        for (i = 0; i < K; ++i) {
+            out[i * stride] = x[i];
+        }
+        in += K * stride;
+        out += K * stride;
+    }
+}
+
+#if defined(AUDIO_SIMD_X86) && BIQUAD_BLOCK_SIZE == 8
+
+// Same as block_process(), one output sample per lane of a 256-bit vector.
+// The delays of a section are kept in registers through the whole call. The
+// product of the inputs does not depend on them, so only the four
+// multiply-adds of the delays are on the critical path from block to block.
+AUDIO_TARGET("avx2,fma")
+static void block_process_x8(const audio_coef_float_t (* const matrices[])[K],
+	audio_sample_float_t delays[][MAX_CHANNELS][4], int numSections, int ch,
+	const audio_sample_float_t *in, audio_sample_float_t *out, int numBlocks, int stride) {
+
+	int j = 0;
+	int s = 0;
+	__m256 x, y, yx;
+	__m128 hi;
+	float d[MAX_CASCADE_SECTIONS][4];
+	const __m256i gather = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+	                                          _mm256_set1_epi32(stride));
+
+    for (s = 0; s < numSections; ++s) {
+        memcpy(d[s], delays[s][ch], sizeof(d[s]));
+    }
+    while (numBlocks-- > 0) {
+        if (stride == 1) {
+            x = _mm256_loadu_ps(in);
+        } else {
+            x = _mm256_i32gather_ps(in, gather, sizeof(float));
+        }
+        for (s = 0; s < numSections; ++s) {
+            const audio_coef_float_t (*m)[K] = matrices[s];
+            float xs[K];
+            _mm256_storeu_ps(xs, x);
+            yx = _mm256_mul_ps(_mm256_loadu_ps(m[0]), _mm256_set1_ps(xs[0]));
+            for (j = 1; j < K; ++j) {
+                yx = _mm256_fmadd_ps(_mm256_loadu_ps(m[j]), _mm256_set1_ps(xs[j]), yx);
+            }
+            y = _mm256_mul_ps(_mm256_loadu_ps(m[K]), _mm256_set1_ps(d[s][0]));
+            y = _mm256_fmadd_ps(_mm256_loadu_ps(m[K + 1]), _mm256_set1_ps(d[s][1]), y);
+            y = _mm256_fmadd_ps(_mm256_loadu_ps(m[K + 2]), _mm256_set1_ps(d[s][2]), y);
+            y = _mm256_fmadd_ps(_mm256_loadu_ps(m[K + 3]), _mm256_set1_ps(d[s][3]), y);
+            y = _mm256_add_ps(y, yx);
+            hi = _mm256_extractf128_ps(y, 1);
+            d[s][0] = xs[K - 1];
+            d[s][1] = xs[K - 2];
+            d[s][2] = _mm_cvtss_f32(_mm_shuffle_ps(hi, hi, _MM_SHUFFLE(3, 3, 3, 3)));
+            d[s][3] = _mm_cvtss_f32(_mm_shuffle_ps(hi, hi, _MM_SHUFFLE(2, 2, 2, 2)));
+            x = y;
+        }
+        if (stride == 1) {
+            _mm256_storeu_ps(out, x);
+        } else {
+            float xs[K];
+            _mm256_storeu_ps(xs, x);
+            for (j = 0; j < K; ++j) {
+                out[j * stride] = xs[j];
+            }
+        }
+        in += K * stride;
+        out += K * stride;
+    }
+    for (s = 0; s < numSections; ++s) {
+        memcpy(delays[s][ch], d[s], sizeof(d[s]));
+    }
+}
+
+#endif
+
+void AudioBiquadBlockCompute(AudioBiquadFilter *mBiquad) {
+	int i = 0;
+	int n = 0;
+	int col = 0;
+	double c[NUM_COEFS];
+	double x[K + 2];
+	double y[K + 2];
+    for (i = 0; i < NUM_COEFS; ++i) {
+        c[i] = (double) mBiquad->mCoefs[i] / AUDIO_COEF_ONE;
+    }
+    // Each column is the response of the recursion to a unit input sample,
+    // or to a unit delay, with everything else zero. x[0], x[1], y[0] and
+    // y[1] are x2, x1, y2 and y1 respectively.
+    for (col = 0; col < K + 4; ++col) {
+        memset(x, 0, sizeof(x));
+        memset(y, 0, sizeof(y));
+        if (col < K) {
+            x[col + 2] = 1.0;
+        } else if (col == K) {
+            x[1] = 1.0;
+        } else if (col == K + 1) {
+            x[0] = 1.0;
+        } else if (col == K + 2) {
+            y[1] = 1.0;
+        } else {
+            y[0] = 1.0;
+        }
+        for (n = 2; n < K + 2; ++n) {
+            y[n] = c[0] * x[n] + c[1] * x[n - 1] + c[2] * x[n - 2]
+                    + c[3] * y[n - 1] + c[4] * y[n - 2];
+            mBiquad->mBlockMatrix[col][n - 2] = (audio_coef_float_t) y[n];
+        }
+    }
+    memcpy(mBiquad->mBlockCoefs, mBiquad->mCoefs, sizeof(mBiquad->mBlockCoefs));
+}
+
+void AudioBiquadBlockUpdate(AudioBiquadFilter *mBiquad) {
+    if (memcmp(mBiquad->mBlockCoefs, mBiquad->mCoefs, sizeof(mBiquad->mBlockCoefs)) != 0) {
+        AudioBiquadBlockCompute(mBiquad);
+    }
+}
+
+int AudioBiquadBlockProcess(const audio_coef_float_t (* const matrices[])[BIQUAD_BLOCK_SIZE],
+	audio_sample_float_t delays[][MAX_CHANNELS][4], int numSections, int ch,
+	const audio_sample_float_t *pIn, audio_sample_float_t *pOut, int frameCount, int stride) {
+
+	const int numBlocks = frameCount / K;
+    assert(numSections > 0 && numSections <= MAX_CASCADE_SECTIONS);
+#if defined(AUDIO_SIMD_X86) && BIQUAD_BLOCK_SIZE == 8
+    if (AudioSimdHasAvx2() && AudioSimdHasFma()) {
+        block_process_x8(matrices, delays, numSections, ch, pIn, pOut, numBlocks, stride);
+        return numBlocks * K;
+    }
+#endif
+    block_process(matrices, delays, numSections, ch, pIn, pOut, numBlocks, stride);
+    return numBlocks * K;
+}
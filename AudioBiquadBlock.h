@@ -0,0 +1,57 @@
+/*
+**
+** Copyright 2009, The Android Open Source Project
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef ANDROID_AUDIO_BIQUAD_BLOCK_H
+#define ANDROID_AUDIO_BIQUAD_BLOCK_H
+
+#include "AudioBiquadFilter.h"
+
+// Block state-space processing for the floating point engine.
+// The recursion of a biquad makes every output sample wait for the previous
+// one, so a single stream runs at the latency of a multiply-add chain per
+// sample, and cannot use vector units. In block mode, the filter instead
+// produces BIQUAD_BLOCK_SIZE outputs at once:
+//   y = H * x + G * d
+// where x are the block's inputs, d the delays (x1, x2, y1, y2) at the start
+// of the block, H the lower-triangular Toeplitz matrix of the impulse
+// response and G the response to each of the delays. Each output depends on
+// the inputs and the delays only, so the products vectorize across time, one
+// output per lane, and only the delays carry over from block to block.
+// This costs BIQUAD_BLOCK_SIZE / 2 + 4 multiply-adds per sample instead of 5,
+// so it only pays off with wide vectors, on long single-channel streams.
+// The matrix is computed in double precision from the current coefficients,
+// and recomputed whenever they change. Block mode only applies to steady
+// filters; transitions use the per-sample ramp.
+
+// Computes the block matrix of the filter for its current coefficients.
+void AudioBiquadBlockCompute(AudioBiquadFilter *mBiquad);
+
+// Recomputes the block matrix if the coefficients changed since it was last
+// computed.
+void AudioBiquadBlockUpdate(AudioBiquadFilter *mBiquad);
+
+// Runs channel ch of a block through numSections sections in block mode.
+// matrices[s] is the block matrix of section s, delays[s][ch] its delay line.
+// stride is the distance between two consecutive samples of the channel.
+// Returns the number of frames processed, which is frameCount rounded down to
+// a multiple of BIQUAD_BLOCK_SIZE; the rest is left for the sample by sample
+// code.
+int AudioBiquadBlockProcess(const audio_coef_float_t (* const matrices[])[BIQUAD_BLOCK_SIZE],
+	audio_sample_float_t delays[][MAX_CHANNELS][4], int numSections, int ch,
+	const audio_sample_float_t *pIn, audio_sample_float_t *pOut, int frameCount, int stride);
+
+#endif // ANDROID_AUDIO_BIQUAD_BLOCK_H
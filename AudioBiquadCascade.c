@@ -0,0 +1,313 @@
+/*
+**
+** Copyright 2009, The Android Open Source Project
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include <string.h>
+#include <assert.h>
+#include "AudioBiquadCascade.h"
+#include "AudioBiquadSimd.h"
+#include "AudioBiquadBlock.h"
+
+// Runs channel ch of a block through numSections sections. stride is the
+// distance between two consecutive samples of the channel.
+static void process_cascade_channel(const audio_coef_t coefs[][NUM_COEFS],
+	audio_sample_t delays[][MAX_CHANNELS][4], int numSections, int ch,
+	const audio_sample_t * in, audio_sample_t * out, int frameCount, int stride) {
+
+	int s = 0;
+	audio_coef_sample_acc_t acc;
+	audio_sample_t x0, y0;
+	audio_sample_t *d;
+    while (frameCount-- > 0) {
+        x0 = *in;
+        for (s = 0; s < numSections; ++s) {
+            d = delays[s][ch];
+            acc = mul_coef_sample(coefs[s][0], x0);
+            acc = mac_coef_sample(coefs[s][1], d[0], acc);
+            acc = mac_coef_sample(coefs[s][2], d[1], acc);
+            acc = mac_coef_sample(coefs[s][3], d[2], acc);
+            acc = mac_coef_sample(coefs[s][4], d[3], acc);
+            y0 = coef_sample_acc_to_sample(acc);
+            d[1] = d[0];
+            d[0] = x0;
+            d[3] = d[2];
+            d[2] = y0;
+            // The output of a section is the input of the next one.
+            x0 = y0;
+        }
+        *out = x0;
+        in += stride;
+        out += stride;
+    }
+}
+
+// Same as process_cascade_channel(), on 16 bit samples. Adds the number of
+// samples clipped to *pClipped.
+static void process_cascade_channel_s16(const audio_coef_t coefs[][NUM_COEFS],
+	audio_sample_t delays[][MAX_CHANNELS][4], int numSections, int ch,
+	const int16_t * in, int16_t * out, int frameCount, int stride, bool accumulate,
+	uint32_t *pClipped) {
+
+	int s = 0;
+	audio_coef_sample_acc_t acc;
+	audio_sample_t x0, y0;
+	audio_sample_t *d;
+	uint32_t clipped = 0;
+    while (frameCount-- > 0) {
+        x0 = s15_to_audio_sample_t(*in);
+        for (s = 0; s < numSections; ++s) {
+            d = delays[s][ch];
+            acc = mul_coef_sample(coefs[s][0], x0);
+            acc = mac_coef_sample(coefs[s][1], d[0], acc);
+            acc = mac_coef_sample(coefs[s][2], d[1], acc);
+            acc = mac_coef_sample(coefs[s][3], d[2], acc);
+            acc = mac_coef_sample(coefs[s][4], d[3], acc);
+            y0 = coef_sample_acc_to_sample(acc);
+            d[1] = d[0];
+            d[0] = x0;
+            d[3] = d[2];
+            d[2] = y0;
+            x0 = y0;
+        }
+        clipped += audio_sample_t_s15_clips(x0);
+        if (accumulate) {
+            *out += audio_sample_t_to_s15_clip(x0);
+        } else {
+            *out = audio_sample_t_to_s15_clip(x0);
+        }
+        in += stride;
+        out += stride;
+    }
+    *pClipped += clipped;
+}
+
+// Same as process_cascade_channel(), on floating point samples.
+static void process_cascade_channel_float(const audio_coef_float_t coefs[][NUM_COEFS],
+	audio_sample_float_t delays[][MAX_CHANNELS][4], int numSections, int ch,
+	const audio_sample_float_t * in, audio_sample_float_t * out, int frameCount, int stride) {
+
+	int s = 0;
+	audio_sample_float_t x0, y0;
+	audio_sample_float_t *d;
+    while (frameCount-- > 0) {
+        x0 = *in;
+        for (s = 0; s < numSections; ++s) {
+            d = delays[s][ch];
+            y0 = coefs[s][0] * x0 + coefs[s][1] * d[0] + coefs[s][2] * d[1]
+                    + coefs[s][3] * d[2] + coefs[s][4] * d[3];
+            d[1] = d[0];
+            d[0] = x0;
+            d[3] = d[2];
+            d[2] = y0;
+            x0 = y0;
+        }
+        *out = x0;
+        in += stride;
+        out += stride;
+    }
+}
+
+// Flushes delay values that are decaying toward the denormal range to zero.
+// Denormal arithmetic is very slow on most CPUs, and the tail of a filter
+// fed with silence would otherwise end up there. Below -600dB, nothing is
+// audible anyway.
+static audio_sample_float_t flush_denormal(audio_sample_float_t x) {
+    return (x < 1e-30f && x > -1e-30f) ? 0.0f : x;
+}
+
+void AudioBiquadCascadeReset(AudioBiquadCascade *pCascade, int nChannels) {
+    assert(nChannels > 0 && nChannels <= MAX_CHANNELS);
+    pCascade->mNumChannels = nChannels;
+    pCascade->mNumSections = 0;
+}
+
+void AudioBiquadCascadeAdd(AudioBiquadCascade *pCascade, AudioBiquadFilter *mBiquad) {
+    assert(pCascade->mNumSections < MAX_CASCADE_SECTIONS);
+    assert(pCascade->mNumChannels == mBiquad->mNumChannels);
+    pCascade->mpSections[pCascade->mNumSections++] = mBiquad;
+}
+
+void AudioBiquadCascadeProcess(AudioBiquadCascade *pCascade,
+	const audio_sample_t *pIn, audio_sample_t *pOut, int frameCount, effect_sound_track indx) {
+
+	int s = 0;
+	int ch = 0;
+	const int nChannels = pCascade->mNumChannels;
+	const int numSections = pCascade->mNumSections;
+	audio_coef_t coefs[MAX_CASCADE_SECTIONS][NUM_COEFS];
+	audio_sample_t delays[MAX_CASCADE_SECTIONS][MAX_CHANNELS][4];
+
+    if (numSections == 0) {
+        // Everything is bypassed.
+        if (pIn != pOut) {
+            memcpy(pOut, pIn, frameCount * nChannels * sizeof(audio_sample_t));
+        }
+        return;
+    }
+
+    for (s = 0; s < numSections; ++s) {
+        memcpy(coefs[s], pCascade->mpSections[s]->mCoefs, sizeof(coefs[s]));
+        memcpy(delays[s], pCascade->mpSections[s]->mDelays, sizeof(delays[s]));
+    }
+
+    if (nChannels == 1) {
+        // A mono block of one of the tracks.
+        process_cascade_channel(coefs, delays, numSections, indx, pIn, pOut, frameCount, 1);
+    } else {
+        // Interleaved channels go to the vector kernels, any channels left
+        // over are processed one at a time.
+        ch = AudioBiquadSimdProcessMulti(coefs, delays, numSections, pIn, pOut, frameCount, nChannels);
+        for (; ch < nChannels; ++ch) {
+            process_cascade_channel(coefs, delays, numSections, ch, pIn + ch, pOut + ch, frameCount, nChannels);
+        }
+    }
+
+    for (s = 0; s < numSections; ++s) {
+        memcpy(pCascade->mpSections[s]->mDelays, delays[s], sizeof(delays[s]));
+    }
+}
+
+void AudioBiquadCascadeProcessPlanar(AudioBiquadCascade *pCascade,
+	const audio_sample_t * const pIn[], audio_sample_t * const pOut[], int frameCount, int numTracks) {
+
+	int s = 0;
+	int ch = 0;
+	const int numSections = pCascade->mNumSections;
+	audio_coef_t coefs[MAX_CASCADE_SECTIONS][NUM_COEFS];
+	audio_sample_t delays[MAX_CASCADE_SECTIONS][MAX_CHANNELS][4];
+
+    assert(pCascade->mNumChannels == 1);
+    assert(numTracks > 0 && numTracks <= MAX_CHANNELS);
+    if (numSections == 0) {
+        for (ch = 0; ch < numTracks; ++ch) {
+            if (pIn[ch] != pOut[ch]) {
+                memcpy(pOut[ch], pIn[ch], frameCount * sizeof(audio_sample_t));
+            }
+        }
+        return;
+    }
+
+    for (s = 0; s < numSections; ++s) {
+        memcpy(coefs[s], pCascade->mpSections[s]->mCoefs, sizeof(coefs[s]));
+        memcpy(delays[s], pCascade->mpSections[s]->mDelays, sizeof(delays[s]));
+    }
+
+    ch = AudioBiquadSimdProcessPlanar(coefs, delays, numSections, pIn, pOut, frameCount, numTracks);
+    for (; ch < numTracks; ++ch) {
+        process_cascade_channel(coefs, delays, numSections, ch, pIn[ch], pOut[ch], frameCount, 1);
+    }
+
+    for (s = 0; s < numSections; ++s) {
+        memcpy(pCascade->mpSections[s]->mDelays, delays[s], sizeof(delays[s]));
+    }
+}
+
+void AudioBiquadCascadeProcessS16(AudioBiquadCascade *pCascade,
+	const int16_t *pIn, int16_t *pOut, int frameCount, effect_sound_track indx, bool accumulate,
+	uint32_t *pClipped) {
+
+	int s = 0;
+	int ch = 0;
+	const int nChannels = pCascade->mNumChannels;
+	const int numSections = pCascade->mNumSections;
+	audio_coef_t coefs[MAX_CASCADE_SECTIONS][NUM_COEFS];
+	audio_sample_t delays[MAX_CASCADE_SECTIONS][MAX_CHANNELS][4];
+
+    if (numSections == 0 && !accumulate) {
+        // A 16 bit sample goes through the conversions unchanged.
+        if (pIn != pOut) {
+            memcpy(pOut, pIn, frameCount * nChannels * sizeof(int16_t));
+        }
+        return;
+    }
+
+    for (s = 0; s < numSections; ++s) {
+        memcpy(coefs[s], pCascade->mpSections[s]->mCoefs, sizeof(coefs[s]));
+        memcpy(delays[s], pCascade->mpSections[s]->mDelays, sizeof(delays[s]));
+    }
+
+    if (nChannels == 1) {
+        process_cascade_channel_s16(coefs, delays, numSections, indx, pIn, pOut, frameCount, 1,
+                accumulate, pClipped);
+    } else {
+        ch = numSections == 0 ? 0 : AudioBiquadSimdProcessMultiS16(coefs, delays, numSections,
+                pIn, pOut, frameCount, nChannels, accumulate, pClipped);
+        for (; ch < nChannels; ++ch) {
+            process_cascade_channel_s16(coefs, delays, numSections, ch, pIn + ch, pOut + ch,
+                    frameCount, nChannels, accumulate, pClipped);
+        }
+    }
+
+    for (s = 0; s < numSections; ++s) {
+        memcpy(pCascade->mpSections[s]->mDelays, delays[s], sizeof(delays[s]));
+    }
+}
+
+void AudioBiquadCascadeProcessFloat(AudioBiquadCascade *pCascade,
+	const audio_sample_float_t *pIn, audio_sample_float_t *pOut, int frameCount, effect_sound_track indx) {
+
+	int s = 0;
+	int ch = 0;
+	int k = 0;
+	int n = 0;
+	bool blockMode = true;
+	const int nChannels = pCascade->mNumChannels;
+	const int numSections = pCascade->mNumSections;
+	audio_coef_float_t coefs[MAX_CASCADE_SECTIONS][NUM_COEFS];
+	audio_sample_float_t delays[MAX_CASCADE_SECTIONS][MAX_CHANNELS][4];
+	const audio_coef_float_t (*matrices[MAX_CASCADE_SECTIONS])[BIQUAD_BLOCK_SIZE];
+
+    if (numSections == 0) {
+        if (pIn != pOut) {
+            memcpy(pOut, pIn, frameCount * nChannels * sizeof(audio_sample_float_t));
+        }
+        return;
+    }
+
+    for (s = 0; s < numSections; ++s) {
+        for (k = 0; k < NUM_COEFS; ++k) {
+            coefs[s][k] = audio_coef_t_to_float(pCascade->mpSections[s]->mCoefs[k]);
+        }
+        memcpy(delays[s], pCascade->mpSections[s]->mFloatDelays, sizeof(delays[s]));
+        // The cascade runs in block mode if all its sections do.
+        if (pCascade->mpSections[s]->mBlockMode) {
+            AudioBiquadBlockUpdate(pCascade->mpSections[s]);
+            matrices[s] = (const audio_coef_float_t (*)[BIQUAD_BLOCK_SIZE]) pCascade->mpSections[s]->mBlockMatrix;
+        } else {
+            blockMode = false;
+        }
+    }
+
+    for (ch = 0; ch < nChannels; ++ch) {
+        // A mono block is one of the tracks.
+        k = nChannels == 1 ? (int) indx : ch;
+        n = 0;
+        if (blockMode) {
+            n = AudioBiquadBlockProcess(matrices, delays, numSections, k, pIn + ch, pOut + ch,
+                    frameCount, nChannels);
+        }
+        process_cascade_channel_float(coefs, delays, numSections, k, pIn + ch + n * nChannels,
+                pOut + ch + n * nChannels, frameCount - n, nChannels);
+    }
+
+    for (s = 0; s < numSections; ++s) {
+        for (ch = 0; ch < MAX_CHANNELS; ++ch) {
+            for (k = 0; k < 4; ++k) {
+                pCascade->mpSections[s]->mFloatDelays[ch][k] = flush_denormal(delays[s][ch][k]);
+            }
+        }
+    }
+}
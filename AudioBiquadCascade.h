@@ -0,0 +1,80 @@
+/*
+**
+** Copyright 2009, The Android Open Source Project
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef ANDROID_AUDIO_BIQUAD_CASCADE_H
+#define ANDROID_AUDIO_BIQUAD_CASCADE_H
+
+#include "AudioBiquadFilter.h"
+
+// A series connection of biquad filters, processed in a single pass.
+// Processing the sections one after the other streams the whole block through
+// memory once per section. The cascade instead takes every sample through all
+// the sections before moving on to the next one, with the coefficients and
+// delay lines of the sections copied to local storage for the duration of the
+// block, so each sample is read and written exactly once.
+// The cascade does not own its sections. It is rebuilt by the client for every
+// block out of the sections that are not bypassed, all of which must be steady
+// (see AudioBiquadIsSteady()), and the delay lines are written back to the
+// sections when the block is done. The output is bit-exact with processing the
+// sections one by one.
+
+// Max number of sections in a cascade, enough for a 31-band graphic EQ. The
+// local storage of a block is sized for it, but only the sections in use are
+// copied and walked.
+#define MAX_CASCADE_SECTIONS  (32)
+
+typedef struct _AudioBiquadCascade_ {
+    // Number of channels.
+    int mNumChannels;
+    // Number of sections.
+    int mNumSections;
+    // The sections, in processing order.
+    AudioBiquadFilter *mpSections[MAX_CASCADE_SECTIONS];
+}AudioBiquadCascade;
+
+void AudioBiquadCascadeReset(AudioBiquadCascade *pCascade, int nChannels);
+
+void AudioBiquadCascadeAdd(AudioBiquadCascade *pCascade, AudioBiquadFilter *mBiquad);
+
+void AudioBiquadCascadeProcess(AudioBiquadCascade *pCascade,
+	const audio_sample_t *pIn, audio_sample_t *pOut, int frameCount, effect_sound_track indx);
+
+// Processes every track of a planar block in one pass: pIn[indx] and
+// pOut[indx] are the buffers of track indx, for indx below numTracks. The
+// cascade must be mono, so that each track has its own delay lines, and the
+// output is bit-exact with one AudioBiquadCascadeProcess() per track. The
+// tracks are processed side by side in vector lanes.
+void AudioBiquadCascadeProcessPlanar(AudioBiquadCascade *pCascade,
+	const audio_sample_t * const pIn[], audio_sample_t * const pOut[], int frameCount, int numTracks);
+
+// Same as AudioBiquadCascadeProcess(), on 16 bit samples, which are widened
+// when loaded and clipped when stored, in the same pass: the output is
+// bit-exact with converting the block with s15_to_audio_sample_t(), processing
+// it, and converting it back with audio_sample_t_to_s15_clip(). If accumulate
+// is true, the output is added to pOut instead of overwriting it. The number
+// of samples clipped (see audio_sample_t_s15_clips()) is added to *pClipped.
+void AudioBiquadCascadeProcessS16(AudioBiquadCascade *pCascade,
+	const int16_t *pIn, int16_t *pOut, int frameCount, effect_sound_track indx, bool accumulate,
+	uint32_t *pClipped);
+
+// Same as AudioBiquadCascadeProcess(), on floating point samples. Uses the
+// floating point delay lines of the sections, and their coefficients
+// converted to floating point.
+void AudioBiquadCascadeProcessFloat(AudioBiquadCascade *pCascade,
+	const audio_sample_float_t *pIn, audio_sample_float_t *pOut, int frameCount, effect_sound_track indx);
+
+#endif // ANDROID_AUDIO_BIQUAD_CASCADE_H
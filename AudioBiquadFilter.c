@@ -18,11 +18,14 @@
 #include <string.h>
 #include <assert.h>
 #include "AudioBiquadFilter.h"
+#include "AudioBiquadCascade.h"
+#include "AudioBiquadSimd.h"
+#include "AudioBiquadBlock.h"
 
 const audio_coef_t IDENTITY_COEFS[NUM_COEFS] = { AUDIO_COEF_ONE, 0, 0, 0, 0 };
 
 static void setState(AudioBiquadFilter *mBiquad, state_t state);
-static bool updateCoefs(AudioBiquadFilter *mBiquad, const audio_coef_t coefs[NUM_COEFS], int frameCount);
+static process_func getProcessFunc(AudioBiquadFilter *mBiquad);
 static void process_normal_mono(AudioBiquadFilter *mBiquad, 
 	const audio_sample_t * in, audio_sample_t * out, int frameCount, effect_sound_track indx);
 static void process_normal_multi(AudioBiquadFilter *mBiquad, 
@@ -36,91 +39,259 @@ static void process_bypass(AudioBiquadFilter *mBiquad,
     }
 }
 
+// Coefficient transitions.
+// During a transition every dirty coefficient moves toward its target by
+// mMaxDelta per sample, so the output is free of steps regardless of the block
+// size. A transition is processed in segments during which each coefficient
+// has a constant increment (+mMaxDelta, -mMaxDelta or 0): a segment ends
+// whenever a coefficient gets closer to its target than a full step. The last
+// step of a coefficient is the remainder, so it lands exactly on the target.
+// Once all the targets are reached, the rest of the block goes to the normal
+// processing function.
+
+// Computes the increments of the next segment of a transition toward coefs,
+// and returns its length, at most frameCount.
+static int ramp_segment(AudioBiquadFilter *mBiquad, const audio_coef_t coefs[NUM_COEFS],
+	int frameCount, audio_coef_t steps[NUM_COEFS]) {
+
+	int i = 0;
+	int64_t diff = 0;
+	int64_t fullSteps = 0;
+	int64_t n = frameCount;
+    for (i = 0; i < NUM_COEFS; ++i) {
+        steps[i] = 0;
+        if (mBiquad->mCoefDirtyBits & (1<<i)) {
+            diff = (int64_t) coefs[i] - mBiquad->mCoefs[i];
+            fullSteps = (diff < 0 ? -diff : diff) / mBiquad->mMaxDelta;
+            if (fullSteps < n) {
+                n = fullSteps;
+            }
+        }
+    }
+    if (n == 0) {
+        // A single sample, taking the remainder steps.
+        n = 1;
+        for (i = 0; i < NUM_COEFS; ++i) {
+            if (mBiquad->mCoefDirtyBits & (1<<i)) {
+                diff = (int64_t) coefs[i] - mBiquad->mCoefs[i];
+                if (diff > mBiquad->mMaxDelta) {
+                    steps[i] = mBiquad->mMaxDelta;
+                } else if (diff < -mBiquad->mMaxDelta) {
+                    steps[i] = -mBiquad->mMaxDelta;
+                } else {
+                    steps[i] = (audio_coef_t) diff;
+                }
+            }
+        }
+    } else {
+        for (i = 0; i < NUM_COEFS; ++i) {
+            if (mBiquad->mCoefDirtyBits & (1<<i)) {
+                steps[i] = coefs[i] > mBiquad->mCoefs[i] ? mBiquad->mMaxDelta : -mBiquad->mMaxDelta;
+            }
+        }
+    }
+    return (int) n;
+}
+
+// Advances the coefficients by a segment of frameCount samples, and clears the
+// dirty bits of the ones that reached their target.
+static void ramp_advance(AudioBiquadFilter *mBiquad, const audio_coef_t coefs[NUM_COEFS],
+	const audio_coef_t steps[NUM_COEFS], int frameCount) {
+
+	int i = 0;
+    for (i = 0; i < NUM_COEFS; ++i) {
+        mBiquad->mCoefs[i] += steps[i] * frameCount;
+        if (mBiquad->mCoefs[i] == coefs[i]) {
+            mBiquad->mCoefDirtyBits &= ~(1<<i);
+        }
+    }
+}
+
+// Processes a segment with ramping coefficients. The coefficients are stepped
+// before every sample, and are shared by nChannels interleaved channels,
+// starting with channel ch (the track, for mono).
+static void process_ramp(AudioBiquadFilter *mBiquad, const audio_coef_t steps[NUM_COEFS],
+	const audio_sample_t * in, audio_sample_t * out, int frameCount, int ch, int nChannels) {
+
+	int i = 0;
+	int c = 0;
+	audio_coef_t coefs[NUM_COEFS];
+	audio_coef_sample_acc_t acc;
+	audio_sample_t x0, y0;
+	audio_sample_t *d;
+    memcpy(coefs, mBiquad->mCoefs, sizeof(coefs));
+    while (frameCount-- > 0) {
+        for (i = 0; i < NUM_COEFS; ++i) {
+            coefs[i] += steps[i];
+        }
+        for (c = 0; c < nChannels; ++c) {
+            d = mBiquad->mDelays[ch + c];
+            x0 = in[c];
+            acc = mul_coef_sample(coefs[0], x0);
+            acc = mac_coef_sample(coefs[1], d[0], acc);
+            acc = mac_coef_sample(coefs[2], d[1], acc);
+            acc = mac_coef_sample(coefs[3], d[2], acc);
+            acc = mac_coef_sample(coefs[4], d[3], acc);
+            y0 = coef_sample_acc_to_sample(acc);
+            d[1] = d[0];
+            d[0] = x0;
+            d[3] = d[2];
+            d[2] = y0;
+            out[c] = y0;
+        }
+        in += nChannels;
+        out += nChannels;
+    }
+}
+
+// Same as process_ramp(), on floating point samples. The ramp itself is
+// integer, so the coefficients do not depend on how a transition is split
+// into blocks.
+static void process_ramp_float(AudioBiquadFilter *mBiquad, const audio_coef_t steps[NUM_COEFS],
+	const audio_sample_float_t * in, audio_sample_float_t * out, int frameCount, int ch, int nChannels) {
+
+	int i = 0;
+	int c = 0;
+	audio_coef_t icoefs[NUM_COEFS];
+	audio_coef_float_t coefs[NUM_COEFS];
+	audio_sample_float_t x0, y0;
+	audio_sample_float_t *d;
+    memcpy(icoefs, mBiquad->mCoefs, sizeof(icoefs));
+    while (frameCount-- > 0) {
+        for (i = 0; i < NUM_COEFS; ++i) {
+            icoefs[i] += steps[i];
+            coefs[i] = audio_coef_t_to_float(icoefs[i]);
+        }
+        for (c = 0; c < nChannels; ++c) {
+            d = mBiquad->mFloatDelays[ch + c];
+            x0 = in[c];
+            y0 = coefs[0] * x0 + coefs[1] * d[0] + coefs[2] * d[1]
+                    + coefs[3] * d[2] + coefs[4] * d[3];
+            d[1] = d[0];
+            d[0] = x0;
+            d[3] = d[2];
+            d[2] = y0;
+            out[c] = y0;
+        }
+        in += nChannels;
+        out += nChannels;
+    }
+}
+
+// Ends a transition whose coefficients reached their target. A filter that
+// ramped to the identity is bypassed, and its delay lines cleared, so they
+// are not stale when it is enabled again.
+static void end_transition(AudioBiquadFilter *mBiquad) {
+    if (mBiquad->mState == STATE_TRANSITION_TO_BYPASS) {
+        AudioBiquadClear(mBiquad);
+        setState(mBiquad, STATE_BYPASS);
+    } else {
+        setState(mBiquad, STATE_NORMAL);
+    }
+}
+
+// Ramps toward coefs for at most frameCount frames, and returns the number of
+// frames processed. The transition is over if it is less than frameCount.
+static int process_transition(AudioBiquadFilter *mBiquad, const audio_coef_t coefs[NUM_COEFS],
+	const audio_sample_t * in, audio_sample_t * out, int frameCount, int ch, int nChannels) {
+
+	int n = 0;
+	int done = 0;
+	audio_coef_t steps[NUM_COEFS];
+    while (done < frameCount && mBiquad->mCoefDirtyBits != 0) {
+        n = ramp_segment(mBiquad, coefs, frameCount - done, steps);
+        process_ramp(mBiquad, steps, in + done * nChannels, out + done * nChannels, n, ch, nChannels);
+        ramp_advance(mBiquad, coefs, steps, n);
+        done += n;
+    }
+    if (mBiquad->mCoefDirtyBits == 0) {
+        end_transition(mBiquad);
+    }
+    return done;
+}
+
 static void process_transition_bypass_mono(AudioBiquadFilter *mBiquad, 
 	const audio_sample_t * in, audio_sample_t * out, int frameCount, effect_sound_track indx)  {
 
-  if (updateCoefs(mBiquad, IDENTITY_COEFS, frameCount)) {
-      setState(mBiquad, STATE_NORMAL);
-  }
-  process_normal_mono(mBiquad, in, out, frameCount, indx);
+    int done = process_transition(mBiquad, IDENTITY_COEFS, in, out, frameCount, indx, 1);
+    process_bypass(mBiquad, in + done, out + done, frameCount - done, indx);
 }
 
 static void process_transition_bypass_multi(AudioBiquadFilter *mBiquad, 
 	const audio_sample_t * in, audio_sample_t * out, int frameCount, effect_sound_track indx)  {
 	
-    if (updateCoefs(mBiquad, IDENTITY_COEFS, frameCount)) {
-        setState(mBiquad, STATE_NORMAL);
-    }
-    process_normal_multi(mBiquad, in, out, frameCount, indx);
+    int done = process_transition(mBiquad, IDENTITY_COEFS, in, out, frameCount, 0, mBiquad->mNumChannels);
+    process_bypass(mBiquad, in + done * mBiquad->mNumChannels, out + done * mBiquad->mNumChannels,
+            frameCount - done, indx);
 }
 
 static void process_transition_normal_mono(AudioBiquadFilter *mBiquad, 
 	const audio_sample_t * in, audio_sample_t * out, int frameCount, effect_sound_track indx) {
 	
-    if (updateCoefs(mBiquad, mBiquad->mTargetCoefs, frameCount)) {
-        setState(mBiquad, STATE_NORMAL);
-    }
-    process_normal_mono(mBiquad, in, out, frameCount, indx);
+    int done = process_transition(mBiquad, mBiquad->mTargetCoefs, in, out, frameCount, indx, 1);
+    process_normal_mono(mBiquad, in + done, out + done, frameCount - done, indx);
 }
 
 static void process_transition_normal_multi(AudioBiquadFilter *mBiquad, 
 	const audio_sample_t * in, audio_sample_t * out, int frameCount, effect_sound_track indx) {
 	
-    if (updateCoefs(mBiquad, mBiquad->mTargetCoefs, frameCount)) {
-        setState(mBiquad, STATE_NORMAL);
+    int done = process_transition(mBiquad, mBiquad->mTargetCoefs, in, out, frameCount, 0, mBiquad->mNumChannels);
+    process_normal_multi(mBiquad, in + done * mBiquad->mNumChannels, out + done * mBiquad->mNumChannels,
+            frameCount - done, indx);
+}
+
+// Same as process_transition(), on floating point samples.
+static int process_transition_float(AudioBiquadFilter *mBiquad, const audio_coef_t coefs[NUM_COEFS],
+	const audio_sample_float_t * in, audio_sample_float_t * out, int frameCount, int ch, int nChannels) {
+
+	int n = 0;
+	int done = 0;
+	audio_coef_t steps[NUM_COEFS];
+    while (done < frameCount && mBiquad->mCoefDirtyBits != 0) {
+        n = ramp_segment(mBiquad, coefs, frameCount - done, steps);
+        process_ramp_float(mBiquad, steps, in + done * nChannels, out + done * nChannels, n, ch, nChannels);
+        ramp_advance(mBiquad, coefs, steps, n);
+        done += n;
+    }
+    if (mBiquad->mCoefDirtyBits == 0) {
+        end_transition(mBiquad);
     }
-    process_normal_multi(mBiquad, in, out, frameCount, indx);
+    return done;
 }
 
 static void setState(AudioBiquadFilter *mBiquad, state_t state) {
     switch (state) {
-    case STATE_BYPASS:
-      mCurProcessFunc = &process_bypass;
-      break;
     case STATE_TRANSITION_TO_BYPASS:
-      if (mBiquad->mNumChannels == 1) {
-        mCurProcessFunc = &process_transition_bypass_mono;
-      } else {
-        mCurProcessFunc = &process_transition_bypass_multi;
-      }
-      mBiquad->mCoefDirtyBits = (1 << NUM_COEFS) - 1;
-      break;
     case STATE_TRANSITION_TO_NORMAL:
-      if (mBiquad->mNumChannels == 1) {
-        mCurProcessFunc = &process_transition_normal_mono;
-      } else {
-        mCurProcessFunc = &process_transition_normal_multi;
-      }
       mBiquad->mCoefDirtyBits = (1 << NUM_COEFS) - 1;
       break;
-    case STATE_NORMAL:
-      if (mBiquad->mNumChannels == 1) {
-        mCurProcessFunc = &process_normal_mono;
-      } else {
-        mCurProcessFunc = &process_normal_multi;
-      }
+    default:
       break;
     }
     mBiquad->mState = state;
+    mBiquad->mProcessFunc = getProcessFunc(mBiquad);
 }
 
-static bool updateCoefs(AudioBiquadFilter *mBiquad, const audio_coef_t coefs[NUM_COEFS], int frameCount) {
-    int i = 0;
-	int64_t maxDelta = mBiquad->mMaxDelta * frameCount;
-    for (i = 0; i < NUM_COEFS; ++i) {
-        if (mBiquad->mCoefDirtyBits & (1<<i)) {
-            audio_coef_t diff = coefs[i] - mBiquad->mCoefs[i];
-            if (diff > maxDelta) {
-                mBiquad->mCoefs[i] += maxDelta;
-            } else if (diff < -maxDelta) {
-                mBiquad->mCoefs[i] -= maxDelta;
-            } else {
-                mBiquad->mCoefs[i] = coefs[i];
-                mBiquad->mCoefDirtyBits ^= (1<<i);
-            }
-        }
+static process_func getProcessFunc(AudioBiquadFilter *mBiquad) {
+    switch (mBiquad->mState) {
+    case STATE_BYPASS:
+      return &process_bypass;
+    case STATE_TRANSITION_TO_BYPASS:
+      if (mBiquad->mNumChannels == 1) {
+        return &process_transition_bypass_mono;
+      }
+      return &process_transition_bypass_multi;
+    case STATE_TRANSITION_TO_NORMAL:
+      if (mBiquad->mNumChannels == 1) {
+        return &process_transition_normal_mono;
+      }
+      return &process_transition_normal_multi;
+    default:
+      if (mBiquad->mNumChannels == 1) {
+        return &process_normal_mono;
+      }
+      return &process_normal_multi;
     }
-    return mBiquad->mCoefDirtyBits == 0;
 }
 
 static void process_normal_mono(AudioBiquadFilter *mBiquad, 
@@ -169,7 +340,12 @@ static void process_normal_multi(AudioBiquadFilter *mBiquad,
     const audio_coef_t a1 = mBiquad->mCoefs[3];
     const audio_coef_t a2 = mBiquad->mCoefs[4];
 	audio_sample_t y0;
-    for (ch = 0; ch < mBiquad->mNumChannels; ++ch) {
+    // Channels are processed in vector lanes when possible.
+    ch = AudioBiquadSimdProcessMulti((const audio_coef_t (*)[NUM_COEFS]) &mBiquad->mCoefs,
+            &mBiquad->mDelays, 1, in, out, frameCount, mBiquad->mNumChannels);
+    in += ch;
+    out += ch;
+    for (; ch < mBiquad->mNumChannels; ++ch) {
         size_t nFrames = frameCount;
         audio_sample_t x1 = mBiquad->mDelays[ch][0];
         audio_sample_t x2 = mBiquad->mDelays[ch][1];
@@ -196,12 +372,14 @@ static void process_normal_multi(AudioBiquadFilter *mBiquad,
         mBiquad->mDelays[ch][1] = x2;
         mBiquad->mDelays[ch][2] = y1;
         mBiquad->mDelays[ch][3] = y2;
-        ///in -= frameCount * mBiquad->mNumChannels - 1;
-        ///out -= frameCount * mBiquad->mNumChannels - 1;
+        in -= frameCount * mBiquad->mNumChannels - 1;
+        out -= frameCount * mBiquad->mNumChannels - 1;
     }
 }
 
 void _AudioBiquadFilter(AudioBiquadFilter *mBiquad, int nChannels, int sampleRate) {
+    mBiquad->mState = STATE_BYPASS;
+    mBiquad->mBlockMode = false;
 	AudioBiquadConfigure(mBiquad, nChannels, sampleRate);///
     AudioBiquadReset(mBiquad);///
 }
@@ -211,6 +389,7 @@ void AudioBiquadConfigure(AudioBiquadFilter *mBiquad, int nChannels, int sampleR
     assert(sampleRate > 0);
     mBiquad->mNumChannels  = nChannels;
     mBiquad->mMaxDelta = (int64_t)(MAX_DELTA_PER_SEC) * AUDIO_COEF_ONE / sampleRate;
+    mBiquad->mProcessFunc = getProcessFunc(mBiquad);
 	AudioBiquadClear(mBiquad);///
 }
 
@@ -222,6 +401,7 @@ void AudioBiquadReset(AudioBiquadFilter *mBiquad) {
 
 void AudioBiquadClear(AudioBiquadFilter *mBiquad) {
     memset(mBiquad->mDelays, 0, sizeof(mBiquad->mDelays));
+    memset(mBiquad->mFloatDelays, 0, sizeof(mBiquad->mFloatDelays));
 }
 
 void AudioBiquadSetCoefs(AudioBiquadFilter *mBiquad, const audio_coef_t *coefs, bool immediate) {
@@ -238,7 +418,36 @@ void AudioBiquadSetCoefs(AudioBiquadFilter *mBiquad, const audio_coef_t *coefs,
 
 void AudioBiquadProcess(AudioBiquadFilter *mBiquad, 
 	const audio_sample_t *pIn, audio_sample_t *pOut, int frameCount, effect_sound_track indx) {
-    mCurProcessFunc(mBiquad, pIn, pOut, frameCount, indx);///??
+    mBiquad->mProcessFunc(mBiquad, pIn, pOut, frameCount, indx);
+}
+
+void AudioBiquadProcessFloat(AudioBiquadFilter *mBiquad,
+	const audio_sample_float_t *pIn, audio_sample_float_t *pOut, int frameCount, effect_sound_track indx) {
+
+	int done = 0;
+	AudioBiquadCascade cascade;
+	const int nChannels = mBiquad->mNumChannels;
+    if (mBiquad->mState == STATE_TRANSITION_TO_BYPASS) {
+        done = process_transition_float(mBiquad, IDENTITY_COEFS, pIn, pOut, frameCount,
+                nChannels == 1 ? indx : 0, nChannels);
+    } else if (mBiquad->mState == STATE_TRANSITION_TO_NORMAL) {
+        done = process_transition_float(mBiquad, mBiquad->mTargetCoefs, pIn, pOut, frameCount,
+                nChannels == 1 ? indx : 0, nChannels);
+    }
+    // The rest of the block is steady, a cascade of one, or none if bypassed.
+    AudioBiquadCascadeReset(&cascade, nChannels);
+    if (!AudioBiquadIsBypassed(mBiquad)) {
+        AudioBiquadCascadeAdd(&cascade, mBiquad);
+    }
+    AudioBiquadCascadeProcessFloat(&cascade, pIn + done * nChannels, pOut + done * nChannels,
+            frameCount - done, indx);
+}
+
+void AudioBiquadSetBlockMode(AudioBiquadFilter *mBiquad, bool enable) {
+    if (enable) {
+        AudioBiquadBlockCompute(mBiquad);
+    }
+    mBiquad->mBlockMode = enable;
 }
 
 void AudioBiquadEnable(AudioBiquadFilter *mBiquad, bool immediate) {
@@ -253,11 +462,34 @@ void AudioBiquadEnable(AudioBiquadFilter *mBiquad, bool immediate) {
 void AudioBiquadDisable(AudioBiquadFilter *mBiquad, bool immediate) {
     if (CC_UNLIKELY(immediate)) {
         memcpy(mBiquad->mCoefs, IDENTITY_COEFS, sizeof(mBiquad->mCoefs));
+        AudioBiquadClear(mBiquad);
         setState(mBiquad, STATE_BYPASS);
     } else {
         setState(mBiquad, STATE_TRANSITION_TO_BYPASS);
     }
 }
 
+bool AudioBiquadIsSteady(AudioBiquadFilter *mBiquad) {
+    return mBiquad->mState == STATE_NORMAL || mBiquad->mState == STATE_BYPASS;
+}
 
+bool AudioBiquadIsBypassed(AudioBiquadFilter *mBiquad) {
+    return mBiquad->mState == STATE_BYPASS;
+}
 
+bool AudioBiquadIsIdle(AudioBiquadFilter *mBiquad, effect_sound_track indx) {
+	int ch = 0;
+	int k = 0;
+	audio_sample_float_t d;
+	const int first = mBiquad->mNumChannels == 1 ? (int) indx : 0;
+    for (ch = first; ch < first + mBiquad->mNumChannels; ++ch) {
+        for (k = 0; k < 4; ++k) {
+            // The fixed point tail is truncated toward zero, and dies out.
+            d = mBiquad->mFloatDelays[ch][k];
+            if (mBiquad->mDelays[ch][k] != 0 || d >= BIQUAD_IDLE_FLOOR || d <= -BIQUAD_IDLE_FLOOR) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
@@ -57,17 +57,31 @@ typedef enum _state_t_ {
 // second.
 ///const audio_coef_t MAX_DELTA_PER_SEC = 2000;
 #define MAX_DELTA_PER_SEC  (2000)
+// Number of samples processed at once in block mode.
+#define BIQUAD_BLOCK_SIZE  (8)
+// Magnitude below which a floating point delay line has decayed to silence
+// (-180 dB).
+#define BIQUAD_IDLE_FLOOR  (1e-9f)
 
 
-typedef struct _AudioBiquadFilter_ {
+// The coefficients of a pass-through filter.
+extern const audio_coef_t IDENTITY_COEFS[NUM_COEFS];
+
+struct _AudioBiquadFilter_;
 
-    // Coefficients of identity transformation.
-    audio_coef_t IDENTITY_COEFS[NUM_COEFS];
+// A prototype of the actual processing function. Has the same semantics as
+// the process() method.
+typedef void (*process_func)(struct _AudioBiquadFilter_ *mBiquad,
+        const audio_sample_t *pIn, audio_sample_t *pOut, int frameCount, effect_sound_track indx);
+
+typedef struct _AudioBiquadFilter_ {
 
     // Number of channels.
     int mNumChannels;
     // Current state.
     state_t mState;
+    // The processing function for the current state and number of channels.
+    process_func mProcessFunc;
     // Maximum coefficient delta per sample.
     audio_coef_t mMaxDelta;
 
@@ -83,16 +97,21 @@ typedef struct _AudioBiquadFilter_ {
 
     // The delay lines.
     audio_sample_t mDelays[MAX_CHANNELS][4];
+    // The delay lines of the floating point engine. The coefficients are
+    // shared with the fixed point engine, and converted for every block.
+    audio_sample_float_t mFloatDelays[MAX_CHANNELS][4];
+
+    // Whether the floating point engine processes this filter in block mode
+    // (see AudioBiquadBlock.h).
+    bool mBlockMode;
+    // The coefficients mBlockMatrix was computed for.
+    audio_coef_t mBlockCoefs[NUM_COEFS];
+    // The block state-space matrix, by column: one column per input sample
+    // of the block, followed by one per delay.
+    audio_coef_float_t mBlockMatrix[BIQUAD_BLOCK_SIZE + 4][BIQUAD_BLOCK_SIZE];
 
 }AudioBiquadFilter;
 
-// A prototype of the actual processing function. Has the same semantics as
-// the process() method.
-typedef void (*process_func)(AudioBiquadFilter *mBiquad, 
-        const audio_sample_t *pIn, audio_sample_t *pOut, int frameCount, effect_sound_track indx);
-
-process_func mCurProcessFunc;
-
 void _AudioBiquadFilter(AudioBiquadFilter *mBiquad, int nChannels, int sampleRate);
 
 void AudioBiquadConfigure(AudioBiquadFilter *mBiquad, int nChannels, int sampleRate);
@@ -106,10 +125,32 @@ void AudioBiquadSetCoefs(AudioBiquadFilter *mBiquad, const audio_coef_t *coefs,
 void AudioBiquadProcess(AudioBiquadFilter *mBiquad, 
 	const audio_sample_t *pIn, audio_sample_t *pOut, int frameCount, effect_sound_track indx);
 
+// Same as AudioBiquadProcess(), on floating point samples.
+void AudioBiquadProcessFloat(AudioBiquadFilter *mBiquad,
+	const audio_sample_float_t *pIn, audio_sample_float_t *pOut, int frameCount, effect_sound_track indx);
+
+// Selects block mode for the floating point engine. See AudioBiquadBlock.h.
+void AudioBiquadSetBlockMode(AudioBiquadFilter *mBiquad, bool enable);
+
 void AudioBiquadEnable(AudioBiquadFilter *mBiquad, bool immediate);
 
 void AudioBiquadDisable(AudioBiquadFilter *mBiquad, bool immediate);
 
+// Returns true if the filter is not in a transition, and its coefficients are
+// constant. Only then can it be processed outside of process(), e.g. as a
+// section of an AudioBiquadCascade; during a transition the coefficients ramp
+// from sample to sample.
+bool AudioBiquadIsSteady(AudioBiquadFilter *mBiquad);
+
+// Returns true if the filter is bypassed, and a block passes through it
+// untouched.
+bool AudioBiquadIsBypassed(AudioBiquadFilter *mBiquad);
+
+// Returns true if the delay lines of track indx (of all the channels, for a
+// multi-channel filter) have decayed to silence, in both engines, so that a
+// silent block would come out silent.
+bool AudioBiquadIsIdle(AudioBiquadFilter *mBiquad, effect_sound_track indx);
+
 
 
 
@@ -0,0 +1,583 @@
+/*
+**
+** Copyright 2009, The Android Open Source Project
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h>
+#include <complex.h>
+#include "AudioBiquadParallel.h"
+#include "AudioSimd.h"
+
+// Max difference between the numerator and the denominator of a flat section,
+// in coefficient units.
+#define FLAT_TOLERANCE  (16)
+// Min distance between two poles for the expansion.
+#define POLE_SEPARATION  (1e-9)
+// Min determinant of the hand-over of a pair of poles, relative to the norm
+// of its matrix.
+#define HANDOVER_CONDITION  (1e-12)
+// State magnitude below which the impulse responses are considered over.
+#define RESPONSE_FLOOR  (1e-13)
+
+// The residues of the cascade of the first t branches, at its 2t poles, in
+// the packed rows of AudioBiquadExpansion::mResidues.
+#define RESIDUES(pExpansion, t)  ((pExpansion)->mResidues + (t) * ((t) - 1))
+
+static const audio_coef_t IDENTITY[NUM_COEFS] = { AUDIO_COEF_ONE, 0, 0, 0, 0 };
+
+static bool is_flat(const audio_coef_t coefs[NUM_COEFS]) {
+    return abs(coefs[0] - AUDIO_COEF_ONE) <= FLAT_TOLERANCE
+            && abs(coefs[1] + coefs[3]) <= FLAT_TOLERANCE
+            && abs(coefs[2] + coefs[4]) <= FLAT_TOLERANCE;
+}
+
+static audio_sample_float_t flush_denormal(audio_sample_float_t x) {
+    return (x < 1e-30f && x > -1e-30f) ? 0.0f : x;
+}
+
+// The hand-over between the delay lines and the modal state.
+// The modal state of pole p at time n is w[n] = p*w[n-1] + x[n]. A filter
+// with residues r_k and direct term c outputs y[n] = c*x[n] + sum_k r_k*w_k[n],
+// so its delay lines (its outputs at n-1 and n-2) are a linear function of the
+// modal state W_k = w_k[n-1] and of the input delays x1 and x2, with
+// w_k[n-2] = (W_k - x1) / p_k. Conversely, the modal state of the poles of a
+// branch can be solved for from two outputs of a filter that has them.
+// The modal state of a complex pair is conjugate, W0 = u + iv and W1 = u - iv,
+// that of a real pair is W0 = u and W1 = v, so a pair has two real unknowns.
+
+// Modal state of the poles of branch j for the unknowns (1, 0) and (0, 1).
+static void pair_basis(const AudioBiquadExpansion *pExpansion, int j, double complex basis[2][2]) {
+    if (cimag(pExpansion->mPoles[2 * j]) != 0.0) {
+        basis[0][0] = 1.0;
+        basis[0][1] = 1.0;
+        basis[1][0] = I;
+        basis[1][1] = -I;
+    } else {
+        basis[0][0] = 1.0;
+        basis[0][1] = 0.0;
+        basis[1][0] = 0.0;
+        basis[1][1] = 1.0;
+    }
+}
+
+// Contribution of the modal state W of numPoles poles to the outputs at n-1
+// and n-2 of a filter with the given residues at these poles.
+static void modal_sum(const double complex residues[], const double complex poles[],
+	const double complex W[], int numPoles, double x1, double y[2]) {
+
+	int k = 0;
+    y[0] = 0.0;
+    y[1] = 0.0;
+    for (k = 0; k < numPoles; ++k) {
+        y[0] += creal(residues[k] * W[k]);
+        y[1] += creal(residues[k] * (W[k] - x1) / poles[k]);
+    }
+}
+
+// Matrix from the unknowns of branch j to the contribution of its poles to the
+// outputs of a filter with the given residues.
+static void pair_matrix(const AudioBiquadExpansion *pExpansion, int j,
+	const double complex residues[], double m[2][2]) {
+
+	int c = 0;
+	double y[2];
+	double complex basis[2][2];
+    pair_basis(pExpansion, j, basis);
+    for (c = 0; c < 2; ++c) {
+        // Relative to the input delay, which is left out here.
+        modal_sum(residues + 2 * j, pExpansion->mPoles + 2 * j, basis[c], 2, 0.0, y);
+        m[0][c] = y[0];
+        m[1][c] = y[1];
+    }
+}
+
+static bool pair_solvable(const AudioBiquadExpansion *pExpansion, int j,
+	const double complex residues[]) {
+
+	double m[2][2];
+    pair_matrix(pExpansion, j, residues, m);
+    return fabs(m[0][0] * m[1][1] - m[0][1] * m[1][0])
+            > HANDOVER_CONDITION * (fabs(m[0][0]) + fabs(m[0][1])) * (fabs(m[1][0]) + fabs(m[1][1]));
+}
+
+// Solves for the modal state of the poles of branch j, given the contribution
+// of these poles (e1, e2) to the outputs of a filter with the given residues.
+static void pair_solve(const AudioBiquadExpansion *pExpansion, int j,
+	const double complex residues[], double e1, double e2, double x1, double complex W[2]) {
+
+	double m[2][2];
+	double det, u, v, y[2];
+	double complex basis[2][2];
+	const double complex zero[2] = { 0.0, 0.0 };
+    pair_matrix(pExpansion, j, residues, m);
+    // Take the input delay out of e2.
+    modal_sum(residues + 2 * j, pExpansion->mPoles + 2 * j, zero, 2, x1, y);
+    e2 -= y[1];
+    det = m[0][0] * m[1][1] - m[0][1] * m[1][0];
+    u = (m[1][1] * e1 - m[0][1] * e2) / det;
+    v = (m[0][0] * e2 - m[1][0] * e1) / det;
+    pair_basis(pExpansion, j, basis);
+    W[0] = u * basis[0][0] + v * basis[1][0];
+    W[1] = u * basis[0][1] + v * basis[1][1];
+}
+
+// Moves the delay lines of channel ch from the sections to the branches.
+static void enter_channel(AudioBiquadParallel *pParallel, int ch) {
+	int s = 0;
+	int j = 0;
+	double x1 = 0.0;
+	double x2 = 0.0;
+	double y[2];
+	double complex W[2 * MAX_PARALLEL_BRANCHES];
+	const audio_sample_float_t *d;
+	const AudioBiquadExpansion *pExpansion = &(pParallel->mExpansion);
+	const int numBranches = pExpansion->mNumBranches;
+    // The input delays are those of the first branch; the flat sections before
+    // it do not change them.
+    for (s = 0; s < pExpansion->mNumSections; ++s) {
+        if (pExpansion->mBranches[s] >= 0) {
+            x1 = pParallel->mpSections[s]->mFloatDelays[ch][0];
+            x2 = pParallel->mpSections[s]->mFloatDelays[ch][1];
+            break;
+        }
+    }
+    // The output delays of the section of branch j are those of the cascade of
+    // the first j+1 branches, which only has the poles of the branches up to j.
+    for (s = 0; s < pExpansion->mNumSections; ++s) {
+        j = pExpansion->mBranches[s];
+        if (j < 0) {
+            continue;
+        }
+        d = pParallel->mpSections[s]->mFloatDelays[ch];
+        modal_sum(RESIDUES(pExpansion, j + 1), pExpansion->mPoles, W, 2 * j, x1, y);
+        pair_solve(pExpansion, j, RESIDUES(pExpansion, j + 1),
+                d[2] - pExpansion->mDirects[j + 1] * x1 - y[0],
+                d[3] - pExpansion->mDirects[j + 1] * x2 - y[1], x1, W + 2 * j);
+    }
+    pParallel->mInDelays[ch][0] = x1;
+    pParallel->mInDelays[ch][1] = x2;
+    for (j = 0; j < numBranches; ++j) {
+        modal_sum(RESIDUES(pExpansion, numBranches) + 2 * j, pExpansion->mPoles + 2 * j, W + 2 * j,
+                2, x1, y);
+        pParallel->mDelays[ch][0][j] = y[0];
+        pParallel->mDelays[ch][1][j] = y[1];
+    }
+    for (s = 0; s < pExpansion->mNumSections; ++s) {
+        memset(pParallel->mpSections[s]->mFloatDelays[ch], 0,
+                sizeof(pParallel->mpSections[s]->mFloatDelays[ch]));
+    }
+}
+
+// Moves the delay lines of channel ch from the branches back to the sections.
+static void leave_channel(AudioBiquadParallel *pParallel, int ch) {
+	int s = 0;
+	int j = 0;
+	int t = 0;
+	double y[2];
+	double complex W[2 * MAX_PARALLEL_BRANCHES];
+	audio_sample_float_t *d;
+	const AudioBiquadExpansion *pExpansion = &(pParallel->mExpansion);
+	const int numBranches = pExpansion->mNumBranches;
+	const double x1 = pParallel->mInDelays[ch][0];
+	const double x2 = pParallel->mInDelays[ch][1];
+    for (j = 0; j < numBranches; ++j) {
+        pair_solve(pExpansion, j, RESIDUES(pExpansion, numBranches),
+                pParallel->mDelays[ch][0][j], pParallel->mDelays[ch][1][j], x1, W + 2 * j);
+    }
+    // Every section is given the outputs of the cascade of the branches before
+    // it as inputs, and those of the cascade up to its own branch as outputs.
+    // Bypassed sections carry no state.
+    y[0] = x1;
+    y[1] = x2;
+    for (s = 0; s < pExpansion->mNumSections; ++s) {
+        d = pParallel->mpSections[s]->mFloatDelays[ch];
+        if (!AudioBiquadIsBypassed(pParallel->mpSections[s])) {
+            d[0] = y[0];
+            d[1] = y[1];
+        }
+        if (pExpansion->mBranches[s] >= 0) {
+            ++t;
+            modal_sum(RESIDUES(pExpansion, t), pExpansion->mPoles, W, 2 * t, x1, y);
+            y[0] += pExpansion->mDirects[t] * x1;
+            y[1] += pExpansion->mDirects[t] * x2;
+        }
+        if (!AudioBiquadIsBypassed(pParallel->mpSections[s])) {
+            d[2] = y[0];
+            d[3] = y[1];
+        }
+    }
+    memset(pParallel->mInDelays[ch], 0, sizeof(pParallel->mInDelays[ch]));
+    memset(pParallel->mDelays[ch], 0, sizeof(pParallel->mDelays[ch]));
+}
+
+// Computes the poles, the residues of the partial cascades and the branch
+// coefficients. Returns false if the expansion does not exist or is not
+// usable.
+static bool expand(AudioBiquadExpansion *pExpansion) {
+	int s = 0;
+	int j = 0;
+	int t = 0;
+	int k = 0;
+	int i = 0;
+	double disc;
+	double b[MAX_PARALLEL_BRANCHES][3];
+	double a[MAX_PARALLEL_BRANCHES][2];
+	double complex w, num, den;
+	double complex *poles = pExpansion->mPoles;
+	const int numBranches = pExpansion->mNumBranches;
+	const double complex *residues = RESIDUES(pExpansion, numBranches);
+
+    for (s = 0; s < pExpansion->mNumSections; ++s) {
+        j = pExpansion->mBranches[s];
+        if (j >= 0) {
+            for (k = 0; k < 3; ++k) {
+                b[j][k] = (double) pExpansion->mSectionCoefs[s][k] / AUDIO_COEF_ONE;
+            }
+            a[j][0] = (double) pExpansion->mSectionCoefs[s][3] / AUDIO_COEF_ONE;
+            a[j][1] = (double) pExpansion->mSectionCoefs[s][4] / AUDIO_COEF_ONE;
+        }
+    }
+
+    // The poles are the roots of z^2 - a1*z - a2. They must be distinct,
+    // non-zero and stable.
+    for (j = 0; j < numBranches; ++j) {
+        if (a[j][1] == 0.0) {
+            return false;
+        }
+        disc = a[j][0] * a[j][0] + 4.0 * a[j][1];
+        if (disc < 0.0) {
+            poles[2 * j] = 0.5 * a[j][0] + 0.5 * sqrt(-disc) * I;
+            poles[2 * j + 1] = conj(poles[2 * j]);
+        } else {
+            poles[2 * j] = 0.5 * (a[j][0] + sqrt(disc));
+            poles[2 * j + 1] = 0.5 * (a[j][0] - sqrt(disc));
+        }
+    }
+    for (k = 0; k < 2 * numBranches; ++k) {
+        if (cabs(poles[k]) >= 1.0) {
+            return false;
+        }
+        for (i = 0; i < k; ++i) {
+            if (cabs(poles[k] - poles[i]) < POLE_SEPARATION) {
+                return false;
+            }
+        }
+    }
+
+    // With w = z^-1, the cascade of the first t branches is N(w) / D(w), where
+    // D(w) is the product of (1 - p_k*w). Its direct term is its value at
+    // infinity, and its residue at p_k is N(1/p_k) / prod_i!=k (1 - p_i/p_k).
+    pExpansion->mDirects[0] = 1.0;
+    for (t = 1; t <= numBranches; ++t) {
+        pExpansion->mDirects[t] = pExpansion->mDirects[t - 1] * (-b[t - 1][2] / a[t - 1][1]);
+        for (k = 0; k < 2 * t; ++k) {
+            w = 1.0 / poles[k];
+            num = 1.0;
+            for (j = 0; j < t; ++j) {
+                num *= b[j][0] + (b[j][1] + b[j][2] * w) * w;
+            }
+            den = 1.0;
+            for (i = 0; i < 2 * t; ++i) {
+                if (i != k) {
+                    den *= 1.0 - poles[i] * w;
+                }
+            }
+            RESIDUES(pExpansion, t)[k] = num / den;
+        }
+    }
+
+    // Each branch combines the terms of its two poles:
+    // r0/(1 - p0*w) + r1/(1 - p1*w) = (r0 + r1 - (r0*p1 + r1*p0)*w) / (1 - a1*w - a2*w^2)
+    memset(pExpansion->mCoefs, 0, sizeof(pExpansion->mCoefs));
+    for (j = 0; j < numBranches; ++j) {
+        pExpansion->mCoefs[0][j] = creal(residues[2 * j] + residues[2 * j + 1]);
+        pExpansion->mCoefs[1][j] = -creal(residues[2 * j] * poles[2 * j + 1]
+                + residues[2 * j + 1] * poles[2 * j]);
+        pExpansion->mCoefs[2][j] = a[j][0];
+        pExpansion->mCoefs[3][j] = a[j][1];
+    }
+    pExpansion->mDirect = pExpansion->mDirects[numBranches];
+
+    // The delay lines are handed over pair by pair, against the cascade up to
+    // the pair on the way in, and against the branch on the way out.
+    for (j = 0; j < numBranches; ++j) {
+        if (!pair_solvable(pExpansion, j, RESIDUES(pExpansion, j + 1))
+                || !pair_solvable(pExpansion, j, residues)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Returns the l1 norm of the difference between the impulse responses of the
+// cascade, at the exact coefficients of its sections, and of the branches, at
+// their single precision coefficients, both run in double precision.
+static double error_bound(const AudioBiquadExpansion *pExpansion) {
+	int n = 0;
+	int s = 0;
+	int j = 0;
+	double x, x1, hc, hp, y, state;
+	double err = 0.0;
+	double c[MAX_CASCADE_SECTIONS][NUM_COEFS];
+	double d[MAX_CASCADE_SECTIONS][4];
+	double v[MAX_PARALLEL_BRANCHES][2];
+	const int numSections = pExpansion->mNumSections;
+	const int numBranches = pExpansion->mNumBranches;
+
+    for (s = 0; s < numSections; ++s) {
+        for (j = 0; j < NUM_COEFS; ++j) {
+            c[s][j] = (double) pExpansion->mSectionCoefs[s][j] / AUDIO_COEF_ONE;
+        }
+    }
+    memset(d, 0, sizeof(d));
+    memset(v, 0, sizeof(v));
+    x1 = 0.0;
+    for (n = 0; n < PARALLEL_ERROR_LENGTH; ++n) {
+        x = n == 0 ? 1.0 : 0.0;
+        state = 0.0;
+        hc = x;
+        for (s = 0; s < numSections; ++s) {
+            y = c[s][0] * hc + c[s][1] * d[s][0] + c[s][2] * d[s][1] + c[s][3] * d[s][2]
+                    + c[s][4] * d[s][3];
+            d[s][1] = d[s][0];
+            d[s][0] = hc;
+            d[s][3] = d[s][2];
+            d[s][2] = y;
+            hc = y;
+            state += fabs(d[s][0]) + fabs(d[s][1]) + fabs(d[s][2]) + fabs(d[s][3]);
+        }
+        hp = pExpansion->mDirect * x;
+        for (j = 0; j < numBranches; ++j) {
+            y = pExpansion->mCoefs[0][j] * x + pExpansion->mCoefs[1][j] * x1
+                    + pExpansion->mCoefs[2][j] * v[j][0] + pExpansion->mCoefs[3][j] * v[j][1];
+            v[j][1] = v[j][0];
+            v[j][0] = y;
+            hp += y;
+            state += fabs(v[j][0]) + fabs(v[j][1]);
+        }
+        x1 = x;
+        err += fabs(hc - hp);
+        if (n > 0 && state < RESPONSE_FLOOR) {
+            break;
+        }
+    }
+    return err;
+}
+
+// Runs channel ch of a block through the branches. stride is the distance
+// between two consecutive samples of the channel.
+static void parallel_channel(AudioBiquadParallel *pParallel, int ch,
+	const audio_sample_float_t * in, audio_sample_float_t * out, int frameCount, int stride) {
+
+	int j = 0;
+	audio_sample_float_t x0, y0, v;
+	audio_sample_float_t *xd = pParallel->mInDelays[ch];
+	audio_sample_float_t (*vd)[MAX_PARALLEL_BRANCHES] = pParallel->mDelays[ch];
+	const audio_coef_float_t (*c)[MAX_PARALLEL_BRANCHES] = pParallel->mExpansion.mCoefs;
+	const int numBranches = pParallel->mExpansion.mNumBranches;
+    while (frameCount-- > 0) {
+        x0 = *in;
+        y0 = pParallel->mExpansion.mDirect * x0;
+        for (j = 0; j < numBranches; ++j) {
+            v = c[0][j] * x0 + c[1][j] * xd[0] + c[2][j] * vd[0][j] + c[3][j] * vd[1][j];
+            vd[1][j] = vd[0][j];
+            vd[0][j] = v;
+            y0 += v;
+        }
+        xd[1] = xd[0];
+        xd[0] = x0;
+        *out = y0;
+        in += stride;
+        out += stride;
+    }
+}
+
+#if defined(AUDIO_SIMD_X86) && MAX_PARALLEL_BRANCHES == 8
+
+// Same as parallel_channel(), one branch per lane of a 256-bit vector. The
+// products that do not depend on the branch's own previous output are summed
+// first, so a single multiply-add per sample is on the critical path.
+AUDIO_TARGET("avx2,fma")
+static void parallel_channel_x8(AudioBiquadParallel *pParallel, int ch,
+	const audio_sample_float_t * in, audio_sample_float_t * out, int frameCount, int stride) {
+
+	__m256 x0, v, v1, v2;
+	__m128 sum;
+	audio_sample_float_t x1 = pParallel->mInDelays[ch][0];
+	audio_sample_float_t x2 = pParallel->mInDelays[ch][1];
+	const __m256 e0 = _mm256_loadu_ps(pParallel->mExpansion.mCoefs[0]);
+	const __m256 e1 = _mm256_loadu_ps(pParallel->mExpansion.mCoefs[1]);
+	const __m256 a1 = _mm256_loadu_ps(pParallel->mExpansion.mCoefs[2]);
+	const __m256 a2 = _mm256_loadu_ps(pParallel->mExpansion.mCoefs[3]);
+	const audio_coef_float_t direct = pParallel->mExpansion.mDirect;
+    v1 = _mm256_loadu_ps(pParallel->mDelays[ch][0]);
+    v2 = _mm256_loadu_ps(pParallel->mDelays[ch][1]);
+    while (frameCount-- > 0) {
+        x0 = _mm256_set1_ps(*in);
+        v = _mm256_fmadd_ps(e1, _mm256_set1_ps(x1), _mm256_mul_ps(e0, x0));
+        v = _mm256_fmadd_ps(a2, v2, v);
+        v = _mm256_fmadd_ps(a1, v1, v);
+        v2 = v1;
+        v1 = v;
+        sum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+        sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+        sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+        x2 = x1;
+        x1 = *in;
+        *out = direct * x1 + _mm_cvtss_f32(sum);
+        in += stride;
+        out += stride;
+    }
+    pParallel->mInDelays[ch][0] = x1;
+    pParallel->mInDelays[ch][1] = x2;
+    _mm256_storeu_ps(pParallel->mDelays[ch][0], v1);
+    _mm256_storeu_ps(pParallel->mDelays[ch][1], v2);
+}
+
+#endif
+
+void AudioBiquadExpansionInit(AudioBiquadExpansion *pExpansion) {
+    pExpansion->mError = HUGE_VAL;
+    pExpansion->mNumSections = 0;
+    pExpansion->mNumBranches = 0;
+}
+
+void AudioBiquadExpansionCompute(AudioBiquadExpansion *pExpansion,
+	const audio_coef_t coefs[][NUM_COEFS], const bool enabled[], int numSections) {
+
+	int s = 0;
+	const audio_coef_t *sectionCoefs;
+    assert(numSections > 0 && numSections <= MAX_CASCADE_SECTIONS);
+    AudioBiquadExpansionInit(pExpansion);
+    pExpansion->mNumSections = numSections;
+    for (s = 0; s < numSections; ++s) {
+        sectionCoefs = enabled[s] ? coefs[s] : IDENTITY;
+        memcpy(pExpansion->mSectionCoefs[s], sectionCoefs, sizeof(pExpansion->mSectionCoefs[s]));
+        pExpansion->mBranches[s] = is_flat(sectionCoefs) ? -1 : pExpansion->mNumBranches++;
+    }
+    if (pExpansion->mNumBranches <= MAX_PARALLEL_BRANCHES && expand(pExpansion)) {
+        pExpansion->mError = error_bound(pExpansion);
+    } else {
+        AudioBiquadExpansionInit(pExpansion);
+    }
+}
+
+void AudioBiquadParallelInit(AudioBiquadParallel *pParallel) {
+    memset(pParallel, 0, sizeof(*pParallel));
+    pParallel->mActive = false;
+    AudioBiquadExpansionInit(&(pParallel->mExpansion));
+}
+
+void AudioBiquadParallelLoad(AudioBiquadParallel *pParallel, const AudioBiquadExpansion *pExpansion,
+	AudioBiquadFilter *sections[], int numSections) {
+
+	int s = 0;
+    assert(pExpansion->mNumSections == 0 || pExpansion->mNumSections == numSections);
+    AudioBiquadParallelRelease(pParallel);
+    pParallel->mExpansion = *pExpansion;
+    for (s = 0; s < pExpansion->mNumSections; ++s) {
+        pParallel->mpSections[s] = sections[s];
+    }
+}
+
+bool AudioBiquadParallelSelect(AudioBiquadParallel *pParallel) {
+	int s = 0;
+	int ch = 0;
+	bool usable = pParallel->mExpansion.mNumSections > 0;
+	AudioBiquadFilter *mBiquad;
+    for (s = 0; usable && s < pParallel->mExpansion.mNumSections; ++s) {
+        mBiquad = pParallel->mpSections[s];
+        usable = AudioBiquadIsSteady(mBiquad) && memcmp(pParallel->mExpansion.mSectionCoefs[s],
+                AudioBiquadIsBypassed(mBiquad) ? IDENTITY : mBiquad->mCoefs,
+                sizeof(pParallel->mExpansion.mSectionCoefs[s])) == 0;
+    }
+    if (!usable) {
+        AudioBiquadParallelRelease(pParallel);
+    } else if (!pParallel->mActive) {
+        for (ch = 0; ch < MAX_CHANNELS; ++ch) {
+            enter_channel(pParallel, ch);
+        }
+        pParallel->mActive = true;
+    }
+    return usable;
+}
+
+void AudioBiquadParallelRelease(AudioBiquadParallel *pParallel) {
+	int ch = 0;
+    if (pParallel->mActive) {
+        for (ch = 0; ch < MAX_CHANNELS; ++ch) {
+            leave_channel(pParallel, ch);
+        }
+        pParallel->mActive = false;
+    }
+}
+
+void AudioBiquadParallelClear(AudioBiquadParallel *pParallel) {
+    memset(pParallel->mInDelays, 0, sizeof(pParallel->mInDelays));
+    memset(pParallel->mDelays, 0, sizeof(pParallel->mDelays));
+}
+
+bool AudioBiquadParallelIsIdle(AudioBiquadParallel *pParallel, int nChannels,
+	effect_sound_track indx) {
+
+	int ch = 0;
+	int k = 0;
+	const audio_sample_float_t *d;
+	const int first = nChannels == 1 ? (int) indx : 0;
+    for (ch = first; ch < first + nChannels; ++ch) {
+        d = &(pParallel->mInDelays[ch][0]);
+        for (k = 0; k < 2; ++k) {
+            if (d[k] >= BIQUAD_IDLE_FLOOR || d[k] <= -BIQUAD_IDLE_FLOOR) {
+                return false;
+            }
+        }
+        d = &(pParallel->mDelays[ch][0][0]);
+        for (k = 0; k < 2 * MAX_PARALLEL_BRANCHES; ++k) {
+            if (d[k] >= BIQUAD_IDLE_FLOOR || d[k] <= -BIQUAD_IDLE_FLOOR) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void AudioBiquadParallelProcess(AudioBiquadParallel *pParallel,
+	const audio_sample_float_t *pIn, audio_sample_float_t *pOut, int frameCount,
+	int nChannels, effect_sound_track indx) {
+
+	int ch = 0;
+	int k = 0;
+	int j = 0;
+    assert(pParallel->mActive);
+    for (ch = 0; ch < nChannels; ++ch) {
+        // A mono block is one of the tracks.
+        k = nChannels == 1 ? (int) indx : ch;
+#if defined(AUDIO_SIMD_X86) && MAX_PARALLEL_BRANCHES == 8
+        if (AudioSimdHasAvx2() && AudioSimdHasFma()) {
+            parallel_channel_x8(pParallel, k, pIn + ch, pOut + ch, frameCount, nChannels);
+        } else
+#endif
+        {
+            parallel_channel(pParallel, k, pIn + ch, pOut + ch, frameCount, nChannels);
+        }
+        for (j = 0; j < MAX_PARALLEL_BRANCHES; ++j) {
+            pParallel->mDelays[k][0][j] = flush_denormal(pParallel->mDelays[k][0][j]);
+            pParallel->mDelays[k][1][j] = flush_denormal(pParallel->mDelays[k][1][j]);
+        }
+    }
+}
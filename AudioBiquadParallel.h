@@ -0,0 +1,144 @@
+/*
+**
+** Copyright 2009, The Android Open Source Project
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef ANDROID_AUDIO_BIQUAD_PARALLEL_H
+#define ANDROID_AUDIO_BIQUAD_PARALLEL_H
+
+#include "AudioBiquadCascade.h"
+
+// Parallel form of a cascade, for the floating point engine.
+// In a cascade every section waits for the output of the previous one, so
+// each sample goes through a chain of numSections dependent recursions. The
+// same transfer function can be written as a sum of one branch per section
+// plus a direct term, by partial fraction expansion:
+//   H(z) = c + sum_j (e0_j + e1_j*z^-1) / (1 - a1_j*z^-1 - a2_j*z^-2)
+// where the branch denominators are those of the sections. All the branches
+// see the same input, so they run side by side, one per vector lane, and only
+// the recursion of a single branch is on the critical path of a sample.
+// The expansion is computed in double precision by AudioBiquadExpansionCompute()
+// whenever the target coefficients of the sections change. That takes far too
+// long for the audio thread, so the client computes it along with the
+// coefficients, and hands it over with them for AudioBiquadParallelLoad(). It
+// only applies while the sections are steady at those coefficients; the
+// client falls back to the cascade otherwise. The delay lines are handed over in both
+// directions through the modal state of the filter (the state of one
+// first-order recursion per pole), so switching between the two forms is
+// seamless. The delay lines of the side that does not hold the state are
+// cleared.
+// The parallel form is not bit-exact with the cascade. The expansion is
+// ill-conditioned for poles close to each other, and its coefficients are
+// rounded to single precision, so the conversion comes with a bound of the
+// difference of the outputs: the l1 norm of the difference of the impulse
+// responses, which bounds the output difference for a full-scale input. The
+// client decides on the acceptable error; the parallel form is only used when
+// the bound is below it.
+// Sections whose numerator matches their denominator within rounding (flat
+// bands) are left out of the expansion, and are part of the error bound.
+
+// Max number of branches, one per section that is not flat. The modal form
+// grows with the square of the number of branches, and the expansion gets
+// ill-conditioned as poles crowd, so a cascade with more sections than that
+// is not expanded, and stays on the cascade.
+#define MAX_PARALLEL_BRANCHES  (8)
+// Max number of samples of the impulse responses compared for the error bound.
+#define PARALLEL_ERROR_LENGTH  (1 << 16)
+
+typedef struct _AudioBiquadExpansion_ {
+    // Error bound of the expansion, HUGE_VAL if there is none.
+    double mError;
+    // Number of sections expanded, 0 if there is no expansion.
+    int mNumSections;
+    // The coefficients each section was expanded for, identity for a disabled
+    // section.
+    audio_coef_t mSectionCoefs[MAX_CASCADE_SECTIONS][NUM_COEFS];
+    // The branch of each section, or -1 if it was left out.
+    int mBranches[MAX_CASCADE_SECTIONS];
+
+    // Number of branches.
+    int mNumBranches;
+    // The direct term.
+    audio_coef_float_t mDirect;
+    // Branch coefficients e0, e1, a1, a2, by branch: mCoefs[coef][branch]. The
+    // coefficients of unused branches are 0.
+    audio_coef_float_t mCoefs[4][MAX_PARALLEL_BRANCHES];
+
+    // The modal form, for handing the delay lines over. The poles of branch j
+    // are mPoles[2j] and mPoles[2j+1]. The residues of the cascade of the
+    // first t branches, at their 2t poles, are mResidues[t(t-1)] onwards, one
+    // packed row per t, and mDirects[t] is its direct term; the row of
+    // mNumBranches is that of the whole filter.
+    double _Complex mPoles[2 * MAX_PARALLEL_BRANCHES];
+    double _Complex mResidues[MAX_PARALLEL_BRANCHES * (MAX_PARALLEL_BRANCHES + 1)];
+    double mDirects[MAX_PARALLEL_BRANCHES + 1];
+}AudioBiquadExpansion;
+
+typedef struct _AudioBiquadParallel_ {
+    // Whether the delay lines are currently held by the parallel form, rather
+    // than by the sections.
+    bool mActive;
+    // The sections of the cascade, in processing order.
+    AudioBiquadFilter *mpSections[MAX_CASCADE_SECTIONS];
+    // The expansion in use.
+    AudioBiquadExpansion mExpansion;
+    // Input delay lines (x1, x2), by channel.
+    audio_sample_float_t mInDelays[MAX_CHANNELS][2];
+    // Branch delay lines (y1, y2), by channel: mDelays[ch][delay][branch].
+    audio_sample_float_t mDelays[MAX_CHANNELS][2][MAX_PARALLEL_BRANCHES];
+}AudioBiquadParallel;
+
+// Sets an expansion to none.
+void AudioBiquadExpansionInit(AudioBiquadExpansion *pExpansion);
+
+// Expands a cascade of numSections sections at the given coefficients, where
+// enabled[s] is false for a section that is bypassed, and computes the error
+// bound. The expansion is none if it does not exist. Takes up to
+// PARALLEL_ERROR_LENGTH samples of simulation, so it must not run on the
+// audio thread.
+void AudioBiquadExpansionCompute(AudioBiquadExpansion *pExpansion,
+	const audio_coef_t coefs[][NUM_COEFS], const bool enabled[], int numSections);
+
+void AudioBiquadParallelInit(AudioBiquadParallel *pParallel);
+
+// Switches to an expansion of the cascade of sections (all the sections of the
+// client, bypassed or not), or to none, whose error bound is within the
+// client's limit. Hands the delay lines back to the sections first if needed.
+// Only copies the expansion, so it can run on the audio thread.
+void AudioBiquadParallelLoad(AudioBiquadParallel *pParallel, const AudioBiquadExpansion *pExpansion,
+	AudioBiquadFilter *sections[], int numSections);
+
+// Returns true if the next block should be processed by
+// AudioBiquadParallelProcess(): there is an expansion, and all the sections
+// are steady at the coefficients it was expanded for. Hands the delay lines
+// over accordingly, so it must be called before every block.
+bool AudioBiquadParallelSelect(AudioBiquadParallel *pParallel);
+
+// Hands the delay lines back to the sections, if the parallel form holds them.
+void AudioBiquadParallelRelease(AudioBiquadParallel *pParallel);
+
+// Clears the delay lines.
+void AudioBiquadParallelClear(AudioBiquadParallel *pParallel);
+
+// Returns true if the delay lines of track indx (of all the channels, for a
+// multi-channel filter) have decayed to silence. See AudioBiquadIsIdle().
+bool AudioBiquadParallelIsIdle(AudioBiquadParallel *pParallel, int nChannels,
+	effect_sound_track indx);
+
+void AudioBiquadParallelProcess(AudioBiquadParallel *pParallel,
+	const audio_sample_float_t *pIn, audio_sample_float_t *pOut, int frameCount,
+	int nChannels, effect_sound_track indx);
+
+#endif // ANDROID_AUDIO_BIQUAD_PARALLEL_H
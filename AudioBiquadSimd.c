@@ -0,0 +1,331 @@
+/*
+**
+** Copyright 2009, The Android Open Source Project
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include <assert.h>
+#include <string.h>
+#include "AudioBiquadSimd.h"
+#include "AudioSimd.h"
+
+#ifdef AUDIO_SIMD_X86
+
+// Channels ch and ch+1, one per 64-bit lane. Only the low 32 bits of a lane
+// take part in _mm_mul_epi32(), so samples and coefficients need not be
+// sign-extended, and the high half of a lane may hold garbage.
+AUDIO_TARGET("sse4.1")
+static void process_multi_x2(const audio_coef_t coefs[][NUM_COEFS],
+	audio_sample_t delays[][MAX_CHANNELS][4], int numSections,
+	const audio_sample_t * in, audio_sample_t * out, int frameCount, int nChannels, int ch) {
+
+	int s = 0;
+	int k = 0;
+	__m128i c[MAX_CASCADE_SECTIONS][NUM_COEFS];
+	__m128i d[MAX_CASCADE_SECTIONS][4];
+	__m128i x0, acc, sign;
+	// Added to negative accumulators, for rounding toward zero.
+	const __m128i round = _mm_set1_epi64x(AUDIO_COEF_ONE - 1);
+
+    for (s = 0; s < numSections; ++s) {
+        for (k = 0; k < NUM_COEFS; ++k) {
+            c[s][k] = _mm_set1_epi32(coefs[s][k]);
+        }
+        for (k = 0; k < 4; ++k) {
+            d[s][k] = _mm_set_epi32(0, delays[s][ch + 1][k], 0, delays[s][ch][k]);
+        }
+    }
+    in += ch;
+    out += ch;
+    while (frameCount-- > 0) {
+        x0 = _mm_unpacklo_epi32(_mm_loadl_epi64((const __m128i *) in), _mm_setzero_si128());
+        for (s = 0; s < numSections; ++s) {
+            acc = _mm_mul_epi32(c[s][0], x0);
+            acc = _mm_add_epi64(acc, _mm_mul_epi32(c[s][1], d[s][0]));
+            acc = _mm_add_epi64(acc, _mm_mul_epi32(c[s][2], d[s][1]));
+            acc = _mm_add_epi64(acc, _mm_mul_epi32(c[s][3], d[s][2]));
+            acc = _mm_add_epi64(acc, _mm_mul_epi32(c[s][4], d[s][3]));
+            sign = _mm_shuffle_epi32(_mm_srai_epi32(acc, 31), _MM_SHUFFLE(3, 3, 1, 1));
+            acc = _mm_add_epi64(acc, _mm_and_si128(sign, round));
+            // Bits 24..55 of the accumulator, which is all we keep of it.
+            acc = _mm_srli_epi64(acc, AUDIO_COEF_PRECISION);
+            d[s][1] = d[s][0];
+            d[s][0] = x0;
+            d[s][3] = d[s][2];
+            d[s][2] = acc;
+            x0 = acc;
+        }
+        _mm_storel_epi64((__m128i *) out, _mm_shuffle_epi32(x0, _MM_SHUFFLE(2, 0, 2, 0)));
+        in += nChannels;
+        out += nChannels;
+    }
+    for (s = 0; s < numSections; ++s) {
+        for (k = 0; k < 4; ++k) {
+            delays[s][ch][k] = _mm_cvtsi128_si32(d[s][k]);
+            delays[s][ch + 1][k] = _mm_extract_epi32(d[s][k], 2);
+        }
+    }
+}
+
+// Same as process_multi_x2(), on 16 bit samples. The output is rounded as by
+// audio_sample_t_to_s15() in two steps, ((x >> 8) + 1) >> 1, which is the
+// same as (x + (1 << 8)) >> 9 but cannot overflow, and clipped by the
+// saturating pack, which is the same as audio_sample_t_to_s15_clip(). The
+// rounded samples out of the S15 range are counted as they go, in the lanes
+// of a vector.
+AUDIO_TARGET("sse4.1")
+static void process_multi_x2_s16(const audio_coef_t coefs[][NUM_COEFS],
+	audio_sample_t delays[][MAX_CHANNELS][4], int numSections,
+	const int16_t * in, int16_t * out, int frameCount, int nChannels, int ch, bool accumulate,
+	uint32_t *pClipped) {
+
+	int s = 0;
+	int k = 0;
+	int32_t pair;
+	__m128i c[MAX_CASCADE_SECTIONS][NUM_COEFS];
+	__m128i d[MAX_CASCADE_SECTIONS][4];
+	__m128i x0, acc, sign, y;
+	const __m128i round = _mm_set1_epi64x(AUDIO_COEF_ONE - 1);
+	const __m128i one = _mm_set1_epi32(1);
+	const __m128i max = _mm_set1_epi32(0x7FFF);
+	const __m128i min = _mm_set1_epi32(-0x8000);
+	__m128i clipped = _mm_setzero_si128();
+
+    for (s = 0; s < numSections; ++s) {
+        for (k = 0; k < NUM_COEFS; ++k) {
+            c[s][k] = _mm_set1_epi32(coefs[s][k]);
+        }
+        for (k = 0; k < 4; ++k) {
+            d[s][k] = _mm_set_epi32(0, delays[s][ch + 1][k], 0, delays[s][ch][k]);
+        }
+    }
+    in += ch;
+    out += ch;
+    while (frameCount-- > 0) {
+        memcpy(&pair, in, sizeof(pair));
+        x0 = _mm_slli_epi32(_mm_cvtepi16_epi32(_mm_cvtsi32_si128(pair)), 9);
+        x0 = _mm_unpacklo_epi32(x0, _mm_setzero_si128());
+        for (s = 0; s < numSections; ++s) {
+            acc = _mm_mul_epi32(c[s][0], x0);
+            acc = _mm_add_epi64(acc, _mm_mul_epi32(c[s][1], d[s][0]));
+            acc = _mm_add_epi64(acc, _mm_mul_epi32(c[s][2], d[s][1]));
+            acc = _mm_add_epi64(acc, _mm_mul_epi32(c[s][3], d[s][2]));
+            acc = _mm_add_epi64(acc, _mm_mul_epi32(c[s][4], d[s][3]));
+            sign = _mm_shuffle_epi32(_mm_srai_epi32(acc, 31), _MM_SHUFFLE(3, 3, 1, 1));
+            acc = _mm_add_epi64(acc, _mm_and_si128(sign, round));
+            acc = _mm_srli_epi64(acc, AUDIO_COEF_PRECISION);
+            d[s][1] = d[s][0];
+            d[s][0] = x0;
+            d[s][3] = d[s][2];
+            d[s][2] = acc;
+            x0 = acc;
+        }
+        y = _mm_shuffle_epi32(x0, _MM_SHUFFLE(2, 0, 2, 0));
+        y = _mm_srai_epi32(_mm_add_epi32(_mm_srai_epi32(y, 8), one), 1);
+        clipped = _mm_sub_epi32(clipped,
+                _mm_or_si128(_mm_cmpgt_epi32(y, max), _mm_cmplt_epi32(y, min)));
+        y = _mm_packs_epi32(y, y);
+        if (accumulate) {
+            memcpy(&pair, out, sizeof(pair));
+            y = _mm_add_epi16(y, _mm_cvtsi32_si128(pair));
+        }
+        pair = _mm_cvtsi128_si32(y);
+        memcpy(out, &pair, sizeof(pair));
+        in += nChannels;
+        out += nChannels;
+    }
+    // The samples are in lanes 0 and 1, and again in lanes 2 and 3.
+    *pClipped += (uint32_t) _mm_cvtsi128_si32(clipped) + (uint32_t) _mm_extract_epi32(clipped, 1);
+    for (s = 0; s < numSections; ++s) {
+        for (k = 0; k < 4; ++k) {
+            delays[s][ch][k] = _mm_cvtsi128_si32(d[s][k]);
+            delays[s][ch + 1][k] = _mm_extract_epi32(d[s][k], 2);
+        }
+    }
+}
+
+// Same as process_multi_x2(), on tracks ch and ch+1 of a planar block, each
+// in its own buffer.
+AUDIO_TARGET("sse4.1")
+static void process_planar_x2(const audio_coef_t coefs[][NUM_COEFS],
+	audio_sample_t delays[][MAX_CHANNELS][4], int numSections,
+	const audio_sample_t * const in[], audio_sample_t * const out[], int frameCount, int ch) {
+
+	int s = 0;
+	int k = 0;
+	int i = 0;
+	__m128i c[MAX_CASCADE_SECTIONS][NUM_COEFS];
+	__m128i d[MAX_CASCADE_SECTIONS][4];
+	__m128i x0, acc, sign;
+	const __m128i round = _mm_set1_epi64x(AUDIO_COEF_ONE - 1);
+	const audio_sample_t * in0 = in[ch];
+	const audio_sample_t * in1 = in[ch + 1];
+	audio_sample_t * out0 = out[ch];
+	audio_sample_t * out1 = out[ch + 1];
+
+    for (s = 0; s < numSections; ++s) {
+        for (k = 0; k < NUM_COEFS; ++k) {
+            c[s][k] = _mm_set1_epi32(coefs[s][k]);
+        }
+        for (k = 0; k < 4; ++k) {
+            d[s][k] = _mm_set_epi32(0, delays[s][ch + 1][k], 0, delays[s][ch][k]);
+        }
+    }
+    for (i = 0; i < frameCount; ++i) {
+        x0 = _mm_set_epi32(0, in1[i], 0, in0[i]);
+        for (s = 0; s < numSections; ++s) {
+            acc = _mm_mul_epi32(c[s][0], x0);
+            acc = _mm_add_epi64(acc, _mm_mul_epi32(c[s][1], d[s][0]));
+            acc = _mm_add_epi64(acc, _mm_mul_epi32(c[s][2], d[s][1]));
+            acc = _mm_add_epi64(acc, _mm_mul_epi32(c[s][3], d[s][2]));
+            acc = _mm_add_epi64(acc, _mm_mul_epi32(c[s][4], d[s][3]));
+            sign = _mm_shuffle_epi32(_mm_srai_epi32(acc, 31), _MM_SHUFFLE(3, 3, 1, 1));
+            acc = _mm_add_epi64(acc, _mm_and_si128(sign, round));
+            acc = _mm_srli_epi64(acc, AUDIO_COEF_PRECISION);
+            d[s][1] = d[s][0];
+            d[s][0] = x0;
+            d[s][3] = d[s][2];
+            d[s][2] = acc;
+            x0 = acc;
+        }
+        // Stored after the loads, so in-place processing is fine.
+        out0[i] = _mm_cvtsi128_si32(x0);
+        out1[i] = _mm_extract_epi32(x0, 2);
+    }
+    for (s = 0; s < numSections; ++s) {
+        for (k = 0; k < 4; ++k) {
+            delays[s][ch][k] = _mm_cvtsi128_si32(d[s][k]);
+            delays[s][ch + 1][k] = _mm_extract_epi32(d[s][k], 2);
+        }
+    }
+}
+
+#if MAX_CHANNELS >= 4
+// Channels ch to ch+3, one per 64-bit lane. Same as process_multi_x2().
+AUDIO_TARGET("avx2")
+static void process_multi_x4(const audio_coef_t coefs[][NUM_COEFS],
+	audio_sample_t delays[][MAX_CHANNELS][4], int numSections,
+	const audio_sample_t * in, audio_sample_t * out, int frameCount, int nChannels, int ch) {
+
+	int s = 0;
+	int k = 0;
+	__m256i c[MAX_CASCADE_SECTIONS][NUM_COEFS];
+	__m256i d[MAX_CASCADE_SECTIONS][4];
+	__m256i x0, acc, sign;
+	const __m256i round = _mm256_set1_epi64x(AUDIO_COEF_ONE - 1);
+	// Gathers the low halves of the lanes for storing.
+	const __m256i pack = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+
+    for (s = 0; s < numSections; ++s) {
+        for (k = 0; k < NUM_COEFS; ++k) {
+            c[s][k] = _mm256_set1_epi32(coefs[s][k]);
+        }
+        for (k = 0; k < 4; ++k) {
+            d[s][k] = _mm256_setr_epi32(delays[s][ch][k], 0, delays[s][ch + 1][k], 0,
+                                        delays[s][ch + 2][k], 0, delays[s][ch + 3][k], 0);
+        }
+    }
+    in += ch;
+    out += ch;
+    while (frameCount-- > 0) {
+        x0 = _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i *) in));
+        for (s = 0; s < numSections; ++s) {
+            acc = _mm256_mul_epi32(c[s][0], x0);
+            acc = _mm256_add_epi64(acc, _mm256_mul_epi32(c[s][1], d[s][0]));
+            acc = _mm256_add_epi64(acc, _mm256_mul_epi32(c[s][2], d[s][1]));
+            acc = _mm256_add_epi64(acc, _mm256_mul_epi32(c[s][3], d[s][2]));
+            acc = _mm256_add_epi64(acc, _mm256_mul_epi32(c[s][4], d[s][3]));
+            sign = _mm256_shuffle_epi32(_mm256_srai_epi32(acc, 31), _MM_SHUFFLE(3, 3, 1, 1));
+            acc = _mm256_add_epi64(acc, _mm256_and_si256(sign, round));
+            acc = _mm256_srli_epi64(acc, AUDIO_COEF_PRECISION);
+            d[s][1] = d[s][0];
+            d[s][0] = x0;
+            d[s][3] = d[s][2];
+            d[s][2] = acc;
+            x0 = acc;
+        }
+        _mm_storeu_si128((__m128i *) out,
+                         _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(x0, pack)));
+        in += nChannels;
+        out += nChannels;
+    }
+    for (s = 0; s < numSections; ++s) {
+        for (k = 0; k < 4; ++k) {
+            delays[s][ch][k] = _mm256_extract_epi32(d[s][k], 0);
+            delays[s][ch + 1][k] = _mm256_extract_epi32(d[s][k], 2);
+            delays[s][ch + 2][k] = _mm256_extract_epi32(d[s][k], 4);
+            delays[s][ch + 3][k] = _mm256_extract_epi32(d[s][k], 6);
+        }
+    }
+}
+#endif // MAX_CHANNELS >= 4
+
+#endif // AUDIO_SIMD_X86
+
+int AudioBiquadSimdProcessMulti(const audio_coef_t coefs[][NUM_COEFS],
+	audio_sample_t delays[][MAX_CHANNELS][4], int numSections,
+	const audio_sample_t *pIn, audio_sample_t *pOut, int frameCount, int nChannels) {
+
+	int ch = 0;
+    assert(numSections > 0 && numSections <= MAX_CASCADE_SECTIONS);
+#ifdef AUDIO_SIMD_X86
+#if MAX_CHANNELS >= 4
+    if (AudioSimdHasAvx2()) {
+        for (; ch + 4 <= nChannels; ch += 4) {
+            process_multi_x4(coefs, delays, numSections, pIn, pOut, frameCount, nChannels, ch);
+        }
+    }
+#endif
+    if (AudioSimdHasSse41()) {
+        for (; ch + 2 <= nChannels; ch += 2) {
+            process_multi_x2(coefs, delays, numSections, pIn, pOut, frameCount, nChannels, ch);
+        }
+    }
+#endif
+    return ch;
+}
+
+int AudioBiquadSimdProcessMultiS16(const audio_coef_t coefs[][NUM_COEFS],
+	audio_sample_t delays[][MAX_CHANNELS][4], int numSections,
+	const int16_t *pIn, int16_t *pOut, int frameCount, int nChannels, bool accumulate,
+	uint32_t *pClipped) {
+
+	int ch = 0;
+    assert(numSections > 0 && numSections <= MAX_CASCADE_SECTIONS);
+#ifdef AUDIO_SIMD_X86
+    if (AudioSimdHasSse41()) {
+        for (; ch + 2 <= nChannels; ch += 2) {
+            process_multi_x2_s16(coefs, delays, numSections, pIn, pOut, frameCount, nChannels, ch,
+                    accumulate, pClipped);
+        }
+    }
+#endif
+    return ch;
+}
+
+int AudioBiquadSimdProcessPlanar(const audio_coef_t coefs[][NUM_COEFS],
+	audio_sample_t delays[][MAX_CHANNELS][4], int numSections,
+	const audio_sample_t * const pIn[], audio_sample_t * const pOut[], int frameCount, int numTracks) {
+
+	int ch = 0;
+    assert(numSections > 0 && numSections <= MAX_CASCADE_SECTIONS);
+#ifdef AUDIO_SIMD_X86
+    if (AudioSimdHasSse41()) {
+        for (; ch + 2 <= numTracks; ch += 2) {
+            process_planar_x2(coefs, delays, numSections, pIn, pOut, frameCount, ch);
+        }
+    }
+#endif
+    return ch;
+}
@@ -0,0 +1,55 @@
+/*
+**
+** Copyright 2009, The Android Open Source Project
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef ANDROID_AUDIO_BIQUAD_SIMD_H
+#define ANDROID_AUDIO_BIQUAD_SIMD_H
+
+#include "AudioBiquadCascade.h"
+
+// Vectorized kernels for interleaved multi-channel biquad processing.
+// The channels of a frame are processed together, one channel per 64-bit
+// vector lane: 2 channels with SSE4.1, 4 with AVX2. The arithmetic is the
+// same 32x32->64 multiply-accumulate, round toward zero and shift as
+// mac_coef_sample() and coef_sample_acc_to_sample(), so the output is
+// bit-exact with the scalar implementation.
+
+// Runs the leading channels of an interleaved block of nChannels channels
+// through a cascade of numSections sections (1 for a single biquad).
+// delays[s][ch] is the delay line of channel ch in section s.
+// Returns the number of leading channels that were processed, which is a
+// multiple of the vector width, possibly 0. The remaining channels are left
+// for the scalar code.
+int AudioBiquadSimdProcessMulti(const audio_coef_t coefs[][NUM_COEFS],
+	audio_sample_t delays[][MAX_CHANNELS][4], int numSections,
+	const audio_sample_t *pIn, audio_sample_t *pOut, int frameCount, int nChannels);
+
+// Same as AudioBiquadSimdProcessMulti(), on 16 bit samples, converted as by
+// AudioBiquadCascadeProcessS16(). If accumulate is true, the output is added
+// to pOut. The number of samples clipped is added to *pClipped.
+int AudioBiquadSimdProcessMultiS16(const audio_coef_t coefs[][NUM_COEFS],
+	audio_sample_t delays[][MAX_CHANNELS][4], int numSections,
+	const int16_t *pIn, int16_t *pOut, int frameCount, int nChannels, bool accumulate,
+	uint32_t *pClipped);
+
+// Same as AudioBiquadSimdProcessMulti(), on a planar block of numTracks
+// tracks: pIn[ch] and pOut[ch] are the buffers of track ch, which uses the
+// delay lines of channel ch.
+int AudioBiquadSimdProcessPlanar(const audio_coef_t coefs[][NUM_COEFS],
+	audio_sample_t delays[][MAX_CHANNELS][4], int numSections,
+	const audio_sample_t * const pIn[], audio_sample_t * const pOut[], int frameCount, int numTracks);
+
+#endif // ANDROID_AUDIO_BIQUAD_SIMD_H
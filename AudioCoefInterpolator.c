@@ -19,7 +19,7 @@
 #include "AudioCoefInterpolator.h"
 
 audio_coef_t interp(audio_coef_t lo, audio_coef_t hi, uint32_t frac);
-static void getCoefRecurse(AudioCoefInterpolator *mCoefInterp, size_t index,
+static void getCoefRecurse(const AudioCoefInterpolator *mCoefInterp, size_t index,
                                            const uint32_t fracCoord[],
                                            audio_coef_t out[], size_t dim);
 
@@ -40,7 +40,7 @@ void _AudioCoefInterpolator(AudioCoefInterpolator *mCoefInterp, size_t nInDims,
     }
 }
 
-void AudioCoefInterpolator_GetCoef(AudioCoefInterpolator *mCoefInterp, int intCoord[], uint32_t fracCoord[],
+void AudioCoefInterpolator_GetCoef(const AudioCoefInterpolator *mCoefInterp, int intCoord[], uint32_t fracCoord[],
                                     audio_coef_t out[]) {
     size_t index = 0;
     size_t dim = mCoefInterp->mNumInDims;
@@ -57,7 +57,7 @@ void AudioCoefInterpolator_GetCoef(AudioCoefInterpolator *mCoefInterp, int intCo
     getCoefRecurse(mCoefInterp, index, fracCoord, out, 0);
 }
 
-static void getCoefRecurse(AudioCoefInterpolator *mCoefInterp, size_t index,
+static void getCoefRecurse(const AudioCoefInterpolator *mCoefInterp, size_t index,
                                            const uint32_t fracCoord[],
                                            audio_coef_t out[], size_t dim) {
 	size_t d = 0;
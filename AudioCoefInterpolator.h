@@ -59,7 +59,7 @@ void _AudioCoefInterpolator(AudioCoefInterpolator *mCoefInterp, size_t nInDims,
                                              size_t nOutDims,
                                              const audio_coef_t * table);
 
-void AudioCoefInterpolator_GetCoef(AudioCoefInterpolator *mCoefInterp, int intCoord[], uint32_t fracCoord[],
+void AudioCoefInterpolator_GetCoef(const AudioCoefInterpolator *mCoefInterp, int intCoord[], uint32_t fracCoord[],
                                     audio_coef_t out[]);
 
 
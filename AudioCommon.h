@@ -29,6 +29,10 @@ typedef int32_t audio_coef_t;
 typedef int32_t audio_sample_t;
 // Accumulator type for coef x sample.
 typedef int64_t audio_coef_sample_acc_t;
+// Audio coefficient type of the floating point engine.
+typedef float audio_coef_float_t;
+// Audio sample type of the floating point engine, 1.0 is full scale.
+typedef float audio_sample_float_t;
 
 // Number of fraction bits for audio coefficient.
 ///static const int AUDIO_COEF_PRECISION = 24;
@@ -69,6 +73,11 @@ static inline audio_sample_t coef_sample_acc_to_sample(audio_coef_sample_acc_t a
     return (audio_sample_t) (acc >> AUDIO_COEF_PRECISION);
 }
 
+// Convert an audio coefficient to floating point.
+static inline audio_coef_float_t audio_coef_t_to_float(audio_coef_t coef) {
+    return coef * (1.0f / AUDIO_COEF_ONE);
+}
+
 // Convert a S15 sample to audio_sample_t
 static inline audio_sample_t s15_to_audio_sample_t(int16_t s15) {
     return ((audio_sample_t)(s15)) << 9;
@@ -91,6 +100,67 @@ static  inline int16_t audio_sample_t_to_s15_clip(audio_sample_t sample) {
     }
 }
 
+// Returns 1 if audio_sample_t_to_s15_clip() clips sample, that is if it is
+// out of the S15 range once rounded, 0 otherwise. A full-scale sample is not
+// clipped.
+static inline uint32_t audio_sample_t_s15_clips(audio_sample_t sample) {
+    return sample >= (0x8000 << 9) - (1 << 8) || sample < -(0x8000 << 9) - (1 << 8);
+}
+
+// Convert a S7.24 sample to audio_sample_t
+static inline audio_sample_t s7_24_to_audio_sample_t(int32_t s724) {
+    return s724;
+}
+
+// Convert a audio_sample_t sample to S7.24 (no clipping)
+static inline int32_t audio_sample_t_to_s7_24(audio_sample_t sample) {
+    return sample;
+}
+
+// Convert a S31 sample to audio_sample_t
+static inline audio_sample_t s31_to_audio_sample_t(int32_t s31) {
+    return s31 >> 7;
+}
+
+// Convert a audio_sample_t sample to S31 (with clipping)
+static inline int32_t audio_sample_t_to_s31_clip(audio_sample_t sample) {
+    if (CC_UNLIKELY(sample >= (1 << 24))) {
+        return 0x7FFFFFFF;
+    } else if (CC_UNLIKELY(sample < -(1 << 24))) {
+        return -0x7FFFFFFF - 1;
+    } else {
+        return (int32_t) ((uint32_t) sample << 7);
+    }
+}
+
+// Convert a S23 sample, as unpacked from 3 bytes, to audio_sample_t
+static inline audio_sample_t s23_to_audio_sample_t(int32_t s23) {
+    return s23 << 1;
+}
+
+// Convert a audio_sample_t sample to S23 (with clipping)
+static inline int32_t audio_sample_t_to_s23_clip(audio_sample_t sample) {
+    if (CC_UNLIKELY(sample >= (0x7FFFFF << 1))) {
+        return 0x7FFFFF;
+    } else if (CC_UNLIKELY(sample <= -(0x800000 << 1))) {
+        return -0x800000;
+    } else {
+        return (sample + 1) >> 1;
+    }
+}
+
+// Unpack a little-endian packed 24 bit sample.
+static inline int32_t unpack_s23(const uint8_t *p) {
+    return (int32_t) ((uint32_t) p[0] << 8 | (uint32_t) p[1] << 16 | (uint32_t) p[2] << 24) >> 8;
+}
+
+// Pack a S23 sample to 3 little-endian bytes.
+static inline void pack_s23(uint8_t *p, int32_t s23) {
+    p[0] = (uint8_t) s23;
+    p[1] = (uint8_t) (s23 >> 8);
+    p[2] = (uint8_t) (s23 >> 16);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 
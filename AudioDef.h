@@ -25,7 +25,10 @@ typedef short INT16;
 typedef unsigned short UINT16;
 typedef enum _audio_format_pcm_ {
     AUDIO_FORMAT_PCM_8_24_BIT,
-    AUDIO_FORMAT_PCM_16_BIT
+    AUDIO_FORMAT_PCM_16_BIT,
+    AUDIO_FORMAT_PCM_FLOAT,
+    AUDIO_FORMAT_PCM_32_BIT,
+    AUDIO_FORMAT_PCM_24_BIT_PACKED
 }audio_format_pcm;
 
 typedef enum _audio_ch_out_ {
@@ -34,6 +37,8 @@ typedef enum _audio_ch_out_ {
 }audio_ch_out;
 
 typedef enum _eq_param_ {
+    // Also settable with EFFECT_CMD_SET_PARAM, from 2 to MAX_EQ_BANDS, while
+    // the effect is disabled. The equalizer starts over, flat.
     EQ_PARAM_NUM_BANDS,
     EQ_PARAM_CUR_PRESET,
     EQ_PARAM_GET_NUM_OF_PRESETS,
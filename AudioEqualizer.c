@@ -17,25 +17,39 @@
 #define LOG_TAG "AudioEqualizer"
 
 #include <assert.h>
+#include <string.h>
 #include <stdlib.h>
+#include <math.h>
 #include "AudioEqualizer.h"
+#include "AudioBiquadCascade.h"
 #include "AudioPeakingFilter.h"
 #include "AudioShelvingFilter.h"
 #include "EffectsMath.h"
 
 void AudioEqualizerReset(AUDIO_EQUALIZER * pEqualizer);
 void AudioEqualizerCommit(AUDIO_EQUALIZER *pEqualizer, bool immediate);
+static void AudioEqualizerUpdateCoefs(AUDIO_EQUALIZER *pEqualizer);
+static void AudioEqualizerGetActive(AUDIO_EQUALIZER *pEqualizer, bool active[]);
+static void AudioEqualizerUpdateBands(AUDIO_EQUALIZER *pEqualizer, const bool active[], bool immediate);
+static void AudioEqualizerPrepare(AUDIO_EQUALIZER *pEqualizer, AudioEqualizerSettings *pSettings,
+	bool immediate);
+static void AudioEqualizerApply(AUDIO_EQUALIZER *pEqualizer, const AudioEqualizerSettings *pSettings);
+static void AudioEqualizerDropParallel(AUDIO_EQUALIZER *pEqualizer);
+static void AudioEqualizerFoldVolume(AUDIO_EQUALIZER *pEqualizer, AudioEqualizerSettings *pSettings);
 
 void _AudioEqualizer(AUDIO_EQUALIZER * pEqualizer, 
 			int32_t bandsNum, 
 			int nChannels, 
 			int sampleRate, 
 			const PRESET_CONFIG * presets, 
-			int32_t mNumPresets) {
+			int32_t mNumPresets,
+			AudioPeakingFilter * pPeakingFilters) {
 			
     int32_t i = 0;
+    assert(bandsNum >= 2 && bandsNum <= MAX_EQ_BANDS);
 	pEqualizer->mSampleRate = sampleRate;
 	pEqualizer->mNumPeaking = bandsNum - 2;
+	pEqualizer->mpPeakingFilters = pPeakingFilters;
 	pEqualizer->mpPresets = presets;
 	pEqualizer->mNumPresets = mNumPresets; 
 	_AudioShelvingFilter(&(pEqualizer->mpLowShelf), kLowShelf, nChannels, sampleRate);
@@ -43,16 +57,29 @@ void _AudioEqualizer(AUDIO_EQUALIZER * pEqualizer,
 	    _AudioPeakingFilter(&(pEqualizer->mpPeakingFilters[i]), nChannels, sampleRate);
 	}
 	_AudioShelvingFilter(&(pEqualizer->mpHighShelf), kHighShelf, nChannels, sampleRate);
+	pEqualizer->mEnabled = false;
+	pEqualizer->mVolume = AUDIO_COEF_ONE;
+	AudioBiquadParallelInit(&(pEqualizer->mParallel));
+	pEqualizer->mParallelEnabled = false;
+	pEqualizer->mMaxParallelError = 0.0;
+	pEqualizer->mParallelError = HUGE_VAL;
+	pEqualizer->mBackSlot = 0;
+	pEqualizer->mPublished = 1;
+	pEqualizer->mNumPublished = 0;
+	pEqualizer->mFrontSlot = 2;
 	AudioEqualizerReset(pEqualizer);
 }
 
 void AudioEqualizerConfigure(AUDIO_EQUALIZER * pEqualizer, int nChannels, int sampleRate) {
 	int i = 0;
+    AudioBiquadParallelClear(&(pEqualizer->mParallel));
     AudioShelvingConfigure(&(pEqualizer->mpLowShelf), nChannels, sampleRate);///low
     for (i = 0; i < pEqualizer->mNumPeaking; ++i) {
         AudioPeakingConfigure(&(pEqualizer->mpPeakingFilters[i]), nChannels, sampleRate);///peaking
     }
     AudioShelvingConfigure(&(pEqualizer->mpHighShelf), nChannels, sampleRate);///high
+    pEqualizer->mDirtyBands = ALL_BANDS_DIRTY;
+    AudioEqualizerDropParallel(pEqualizer);
 }
 
 void AudioEqualizerClear(AUDIO_EQUALIZER * pEqualizer) {
@@ -62,6 +89,7 @@ void AudioEqualizerClear(AUDIO_EQUALIZER * pEqualizer) {
         AudioPeakingClear(&(pEqualizer->mpPeakingFilters[i]));///peaking
     }
     AudioShelvingClear(&(pEqualizer->mpHighShelf));///high
+    AudioBiquadParallelClear(&(pEqualizer->mParallel));
 }
 
 void AudioEqualizerFree(AUDIO_EQUALIZER * pEqualizer) {
@@ -88,6 +116,7 @@ void AudioEqualizerReset(AUDIO_EQUALIZER *pEqualizer) {
     }
     AudioShelvingReset(&(pEqualizer->mpHighShelf));
     AudioShelvingSetFrequency(&(pEqualizer->mpHighShelf), Effects_exp2(centerFreq));///high
+    pEqualizer->mDirtyBands = ALL_BANDS_DIRTY;
 	AudioEqualizerCommit(pEqualizer, true);///
     pEqualizer->mCurPreset = PRESET_CUSTOM;
 }
@@ -101,6 +130,7 @@ void AudioEqualizerSetGain(AUDIO_EQUALIZER * pEqualizer, int band, int32_t milli
     } else {
         AudioPeakingSetGain(&(pEqualizer->mpPeakingFilters[band - 1]), millibel);///peaking
     }
+    pEqualizer->mDirtyBands |= 1u << band;
     pEqualizer->mCurPreset = PRESET_CUSTOM;
 }
 
@@ -113,6 +143,7 @@ void AudioEqualizerSetFrequency(AUDIO_EQUALIZER * pEqualizer, int band, uint32_t
     } else {
         AudioPeakingSetFrequency(&(pEqualizer->mpPeakingFilters[band - 1]), millihertz);///peaking
     }
+    pEqualizer->mDirtyBands |= 1u << band;
     pEqualizer->mCurPreset = PRESET_CUSTOM;
 }
 
@@ -120,6 +151,7 @@ void AudioEqualizerSetBandwidth(AUDIO_EQUALIZER * pEqualizer, int band, uint32_t
     assert(band >= 0 && band < pEqualizer->mNumPeaking + 2);
     if (band > 0 && band < pEqualizer->mNumPeaking + 1) {
         AudioPeakingSetBandwidth(&(pEqualizer->mpPeakingFilters[band - 1]), cents);///peaking
+        pEqualizer->mDirtyBands |= 1u << band;
         pEqualizer->mCurPreset = PRESET_CUSTOM;
     }
 }
@@ -178,6 +210,15 @@ const char * AudioEqualizerGetPresetName(AUDIO_EQUALIZER * pEqualizer, int prese
     }
 }
 
+void AudioEqualizerSetVolume(AUDIO_EQUALIZER * pEqualizer, audio_coef_t volume) {
+    assert(volume >= 0 && volume <= AUDIO_COEF_ONE);
+    pEqualizer->mVolume = volume;
+}
+
+int AudioEqualizerGetNumBands(AUDIO_EQUALIZER * pEqualizer) {
+    return pEqualizer->mNumPeaking + 2;
+}
+
 int AudioEqualizerGetNumPresets(AUDIO_EQUALIZER * pEqualizer) {
     return pEqualizer->mNumPresets;
 }
@@ -202,41 +243,357 @@ void AudioEqualizerSetPreset(AUDIO_EQUALIZER * pEqualizer, int preset) {
 }
 
 void AudioEqualizerCommit(AUDIO_EQUALIZER *pEqualizer, bool immediate) {
+	AudioEqualizerSettings settings;
+    AudioEqualizerPrepare(pEqualizer, &settings, immediate);
+    AudioEqualizerApply(pEqualizer, &settings);
+}
+
+void AudioEqualizerPublish(AUDIO_EQUALIZER *pEqualizer, bool immediate) {
+    AudioEqualizerPrepare(pEqualizer, &(pEqualizer->mSettings[pEqualizer->mBackSlot]), immediate);
+    ++pEqualizer->mNumPublished;
+    // The slot that was published before, picked up or not, is the next one
+    // to write.
+    pEqualizer->mBackSlot = __atomic_exchange_n(&(pEqualizer->mPublished),
+            pEqualizer->mBackSlot | SETTINGS_FRESH, __ATOMIC_ACQ_REL) & ~SETTINGS_FRESH;
+}
+
+uint32_t AudioEqualizerGetNumPublished(AUDIO_EQUALIZER *pEqualizer) {
+    return pEqualizer->mNumPublished;
+}
+
+bool AudioEqualizerFetch(AUDIO_EQUALIZER *pEqualizer) {
+    if (!(__atomic_load_n(&(pEqualizer->mPublished), __ATOMIC_ACQUIRE) & SETTINGS_FRESH)) {
+        return false;
+    }
+    pEqualizer->mFrontSlot = __atomic_exchange_n(&(pEqualizer->mPublished),
+            pEqualizer->mFrontSlot, __ATOMIC_ACQ_REL) & ~SETTINGS_FRESH;
+    AudioEqualizerApply(pEqualizer, &(pEqualizer->mSettings[pEqualizer->mFrontSlot]));
+    return true;
+}
+
+// Computes the settings of the bands for the current parameters. Only the
+// parameters are read, not the biquads. The coefficients are recomputed for
+// the dirty bands only; the parallel form, if selected, for all of them.
+static void AudioEqualizerPrepare(AUDIO_EQUALIZER *pEqualizer, AudioEqualizerSettings *pSettings,
+	bool immediate) {
+
+	const int numBands = pEqualizer->mNumPeaking + 2;
+    AudioEqualizerUpdateCoefs(pEqualizer);
+    memcpy(pSettings->mCoefs, pEqualizer->mBandCoefs, numBands * sizeof(pSettings->mCoefs[0]));
+    AudioEqualizerGetActive(pEqualizer, pSettings->mActive);
+    AudioEqualizerFoldVolume(pEqualizer, pSettings);
+    pSettings->mImmediate = immediate;
+    if (pEqualizer->mParallelEnabled) {
+        AudioBiquadExpansionCompute(&(pSettings->mExpansion), pSettings->mCoefs, pSettings->mActive,
+                numBands);
+    } else {
+        AudioBiquadExpansionInit(&(pSettings->mExpansion));
+    }
+    pEqualizer->mParallelError = pSettings->mExpansion.mError;
+    if (pSettings->mExpansion.mError > pEqualizer->mMaxParallelError) {
+        AudioBiquadExpansionInit(&(pSettings->mExpansion));
+    }
+}
+
+// Scales the numerator of the last band by the volume. A band that would be
+// bypassed becomes a plain gain instead.
+static void AudioEqualizerFoldVolume(AUDIO_EQUALIZER *pEqualizer, AudioEqualizerSettings *pSettings) {
+	int k = 0;
+	const int last = pEqualizer->mNumPeaking + 1;
+	audio_coef_t *coefs = pSettings->mCoefs[last];
+    if (pEqualizer->mVolume == AUDIO_COEF_ONE) {
+        return;
+    }
+    if (!pSettings->mActive[last]) {
+        coefs[0] = AUDIO_COEF_ONE;
+        for (k = 1; k < NUM_COEFS; ++k) {
+            coefs[k] = 0;
+        }
+        pSettings->mActive[last] = true;
+    }
+    for (k = 0; k < 3; ++k) {
+        coefs[k] = (audio_coef_t) (((int64_t) coefs[k] * pEqualizer->mVolume + AUDIO_COEF_HALF)
+                >> AUDIO_COEF_PRECISION);
+    }
+}
+
+// Sets the biquads of the bands to prepared settings. Only the bands whose
+// target changed go through a transition; the others stay steady, unless an
+// immediate commit cuts their current transition short.
+static void AudioEqualizerApply(AUDIO_EQUALIZER *pEqualizer, const AudioEqualizerSettings *pSettings) {
 	int i = 0;
-    AudioShelvingCommit(&(pEqualizer->mpLowShelf), immediate);///low
+	int numSections = 0;
+	AudioBiquadFilter *sections[MAX_CASCADE_SECTIONS];
+    numSections = AudioEqualizerGetSections(pEqualizer, sections);
+    for (i = 0; i < numSections; ++i) {
+        if (memcmp(sections[i]->mTargetCoefs, pSettings->mCoefs[i], sizeof(pSettings->mCoefs[i])) != 0
+                || (pSettings->mImmediate && !AudioBiquadIsSteady(sections[i]))) {
+            AudioBiquadSetCoefs(sections[i], pSettings->mCoefs[i], pSettings->mImmediate);
+        }
+    }
+    // Bands are taken in and out of the chain through a transition, so this
+    // is free of clicks even for an immediate commit.
+    AudioEqualizerUpdateBands(pEqualizer, pSettings->mActive, false);
+    AudioBiquadParallelLoad(&(pEqualizer->mParallel), &(pSettings->mExpansion), sections, numSections);
+}
+
+// Recomputes the coefficients of the dirty bands.
+static void AudioEqualizerUpdateCoefs(AUDIO_EQUALIZER *pEqualizer) {
+	int band = 0;
+	const int numBands = pEqualizer->mNumPeaking + 2;
+    for (band = 0; band < numBands; ++band) {
+        if (!(pEqualizer->mDirtyBands & (1u << band))) {
+            continue;
+        }
+        if (band == 0) {
+            AudioShelvingGetCoefs(&(pEqualizer->mpLowShelf), pEqualizer->mBandCoefs[band]);///low
+        } else if (band == numBands - 1) {
+            AudioShelvingGetCoefs(&(pEqualizer->mpHighShelf), pEqualizer->mBandCoefs[band]);///high
+        } else {
+            AudioPeakingGetCoefs(&(pEqualizer->mpPeakingFilters[band - 1]), pEqualizer->mBandCoefs[band]);///peaking
+        }
+    }
+    pEqualizer->mDirtyBands = 0;
+}
+
+// A band is active if the EQ is enabled and its coefficients, as last
+// computed, are not those of a pass-through.
+static void AudioEqualizerGetActive(AUDIO_EQUALIZER *pEqualizer, bool active[]) {
+	int band = 0;
+    for (band = 0; band < pEqualizer->mNumPeaking + 2; ++band) {
+        active[band] = pEqualizer->mEnabled
+                && memcmp(pEqualizer->mBandCoefs[band], IDENTITY_COEFS, sizeof(IDENTITY_COEFS)) != 0;
+    }
+}
+
+// Enables the active bands, and bypasses the others. Only the bands whose
+// state changes are touched.
+static void AudioEqualizerUpdateBands(AUDIO_EQUALIZER *pEqualizer, const bool active[], bool immediate) {
+	int band = 0;
+	int numSections = 0;
+	AudioBiquadFilter *sections[MAX_CASCADE_SECTIONS];
+    // The parallel form hands the delay lines back to the bands before their
+    // states change.
+    AudioBiquadParallelRelease(&(pEqualizer->mParallel));
+    numSections = AudioEqualizerGetSections(pEqualizer, sections);
+    for (band = 0; band < numSections; ++band) {
+        if (active[band] && !(sections[band]->mState & STATE_ENABLED_MASK)) {
+            AudioBiquadEnable(sections[band], immediate);
+        } else if (!active[band] && (sections[band]->mState & STATE_ENABLED_MASK)) {
+            AudioBiquadDisable(sections[band], immediate);
+        }
+    }
+}
+
+// Drops the parallel form, whose expansion no longer matches the bands, until
+// the next commit.
+static void AudioEqualizerDropParallel(AUDIO_EQUALIZER *pEqualizer) {
+    AudioBiquadParallelRelease(&(pEqualizer->mParallel));
+    AudioBiquadExpansionInit(&(pEqualizer->mParallel.mExpansion));
+}
+
+int AudioEqualizerGetSections(AUDIO_EQUALIZER * pEqualizer, AudioBiquadFilter *sections[]) {
+	int i = 0;
+	int n = 0;
+    sections[n++] = &(pEqualizer->mpLowShelf.mBiquad);///low
     for (i = 0; i < pEqualizer->mNumPeaking; ++i) {
-        AudioPeakingCommit(&(pEqualizer->mpPeakingFilters[i]), immediate);///peaking
+        sections[n++] = &(pEqualizer->mpPeakingFilters[i].mBiquad);///peaking
     }
-    AudioShelvingCommit(&(pEqualizer->mpHighShelf), immediate);///high
+    sections[n++] = &(pEqualizer->mpHighShelf.mBiquad);///high
+    return n;
+}
+
+bool AudioEqualizerIsBypassed(AUDIO_EQUALIZER * pEqualizer) {
+	int i = 0;
+	int numSections = 0;
+	AudioBiquadFilter *sections[MAX_CASCADE_SECTIONS];
+    numSections = AudioEqualizerGetSections(pEqualizer, sections);
+    for (i = 0; i < numSections; ++i) {
+        if (!AudioBiquadIsBypassed(sections[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int AudioEqualizerGetNumBypassed(AUDIO_EQUALIZER * pEqualizer) {
+	int i = 0;
+	int n = 0;
+	int numSections = 0;
+	AudioBiquadFilter *sections[MAX_CASCADE_SECTIONS];
+    numSections = AudioEqualizerGetSections(pEqualizer, sections);
+    for (i = 0; i < numSections; ++i) {
+        if (AudioBiquadIsBypassed(sections[i])) {
+            ++n;
+        }
+    }
+    return n;
+}
+
+bool AudioEqualizerIsIdle(AUDIO_EQUALIZER * pEqualizer, effect_sound_track indx) {
+	int i = 0;
+	int numSections = 0;
+	AudioBiquadFilter *sections[MAX_CASCADE_SECTIONS];
+    if (!AudioEqualizerIsSteady(pEqualizer)) {
+        return false;
+    }
+    numSections = AudioEqualizerGetSections(pEqualizer, sections);
+    for (i = 0; i < numSections; ++i) {
+        if (!AudioBiquadIsBypassed(sections[i]) && !AudioBiquadIsIdle(sections[i], indx)) {
+            return false;
+        }
+    }
+    return AudioBiquadParallelIsIdle(&(pEqualizer->mParallel), sections[0]->mNumChannels, indx);
+}
+
+bool AudioEqualizerIsSteady(AUDIO_EQUALIZER * pEqualizer) {
+	int i = 0;
+	int numSections = 0;
+	AudioBiquadFilter *sections[MAX_CASCADE_SECTIONS];
+    numSections = AudioEqualizerGetSections(pEqualizer, sections);
+    for (i = 0; i < numSections; ++i) {
+        if (!AudioBiquadIsSteady(sections[i])) {
+            return false;
+        }
+    }
+    return true;
 }
 
 void AudioEqualizerProcess(AUDIO_EQUALIZER * pEqualizer, 
 	const audio_sample_t * pIn, audio_sample_t * pOut, int frameCount, effect_sound_track indx) {
 
 	int i = 0;
-    AudioShelvingProcess(&(pEqualizer->mpLowShelf), pIn, pOut, frameCount, indx);///low
-    for (i = 0; i < pEqualizer->mNumPeaking; ++i) {
-        AudioPeakingProcess(&(pEqualizer->mpPeakingFilters[i]), pIn, pOut, frameCount, indx);///peaking
+	int numSections = 0;
+	AudioBiquadFilter *sections[MAX_CASCADE_SECTIONS];
+	AudioBiquadCascade cascade;
+    numSections = AudioEqualizerGetSections(pEqualizer, sections);
+    if (!AudioEqualizerIsSteady(pEqualizer)) {
+        // Some coefficients ramp from sample to sample, so the bands are run
+        // one after the other.
+        for (i = 0; i < numSections; ++i) {
+            AudioBiquadProcess(sections[i], pIn, pOut, frameCount, indx);
+            pIn = pOut;
+        }
+        return;
     }
-    AudioShelvingProcess(&(pEqualizer->mpHighShelf), pIn, pOut, frameCount, indx);///high
+    // All the bands are run in a single pass over the block, skipping the
+    // bypassed ones.
+    AudioBiquadCascadeReset(&cascade, sections[0]->mNumChannels);
+    for (i = 0; i < numSections; ++i) {
+        if (!AudioBiquadIsBypassed(sections[i])) {
+            AudioBiquadCascadeAdd(&cascade, sections[i]);
+        }
+    }
+    AudioBiquadCascadeProcess(&cascade, pIn, pOut, frameCount, indx);
 }
 
-void AudioEqualizerEnable(AUDIO_EQUALIZER * pEqualizer, bool immediate) {
+void AudioEqualizerProcessPlanar(AUDIO_EQUALIZER * pEqualizer,
+	const audio_sample_t * const pIn[], audio_sample_t * const pOut[], int frameCount, int numTracks) {
+
 	int i = 0;
-    AudioShelvingEnable(&(pEqualizer->mpLowShelf), immediate);///low
-    for (i = 0; i < pEqualizer->mNumPeaking; ++i) {
-        AudioPeakingEnable(&(pEqualizer->mpPeakingFilters[i]), immediate);///peaking
+	int numSections = 0;
+	AudioBiquadFilter *sections[MAX_CASCADE_SECTIONS];
+	AudioBiquadCascade cascade;
+    if (!AudioEqualizerIsSteady(pEqualizer)) {
+        // The coefficient ramps run per track anyway.
+        for (i = 0; i < numTracks; ++i) {
+            AudioEqualizerProcess(pEqualizer, pIn[i], pOut[i], frameCount, (effect_sound_track) i);
+        }
+        return;
     }
-    AudioShelvingEnable(&(pEqualizer->mpHighShelf), immediate);///high
+    numSections = AudioEqualizerGetSections(pEqualizer, sections);
+    AudioBiquadCascadeReset(&cascade, sections[0]->mNumChannels);
+    for (i = 0; i < numSections; ++i) {
+        if (!AudioBiquadIsBypassed(sections[i])) {
+            AudioBiquadCascadeAdd(&cascade, sections[i]);
+        }
+    }
+    AudioBiquadCascadeProcessPlanar(&cascade, pIn, pOut, frameCount, numTracks);
 }
 
-void AudioEqualizerDisable(AUDIO_EQUALIZER * pEqualizer, bool immediate) {
+void AudioEqualizerProcessS16(AUDIO_EQUALIZER * pEqualizer,
+	const int16_t * pIn, int16_t * pOut, int frameCount, effect_sound_track indx, bool accumulate,
+	uint32_t *pClipped) {
+
 	int i = 0;
-    AudioShelvingDisable(&(pEqualizer->mpLowShelf), immediate);///low
-    for (i = 0; i < pEqualizer->mNumPeaking; ++i) {
-        AudioPeakingDisable(&(pEqualizer->mpPeakingFilters[i]), immediate);///peaking
+	int numSections = 0;
+	AudioBiquadFilter *sections[MAX_CASCADE_SECTIONS];
+	AudioBiquadCascade cascade;
+    assert(AudioEqualizerIsSteady(pEqualizer));
+    numSections = AudioEqualizerGetSections(pEqualizer, sections);
+    AudioBiquadCascadeReset(&cascade, sections[0]->mNumChannels);
+    for (i = 0; i < numSections; ++i) {
+        if (!AudioBiquadIsBypassed(sections[i])) {
+            AudioBiquadCascadeAdd(&cascade, sections[i]);
+        }
+    }
+    AudioBiquadCascadeProcessS16(&cascade, pIn, pOut, frameCount, indx, accumulate, pClipped);
+}
+
+void AudioEqualizerProcessFloat(AUDIO_EQUALIZER * pEqualizer,
+	const audio_sample_float_t * pIn, audio_sample_float_t * pOut, int frameCount, effect_sound_track indx) {
+
+	int i = 0;
+	int numSections = 0;
+	AudioBiquadFilter *sections[MAX_CASCADE_SECTIONS];
+	AudioBiquadCascade cascade;
+    numSections = AudioEqualizerGetSections(pEqualizer, sections);
+    if (AudioBiquadParallelSelect(&(pEqualizer->mParallel))) {
+        AudioBiquadParallelProcess(&(pEqualizer->mParallel), pIn, pOut, frameCount,
+                sections[0]->mNumChannels, indx);
+        return;
+    }
+    if (!AudioEqualizerIsSteady(pEqualizer)) {
+        for (i = 0; i < numSections; ++i) {
+            AudioBiquadProcessFloat(sections[i], pIn, pOut, frameCount, indx);
+            pIn = pOut;
+        }
+        return;
+    }
+    AudioBiquadCascadeReset(&cascade, sections[0]->mNumChannels);
+    for (i = 0; i < numSections; ++i) {
+        if (!AudioBiquadIsBypassed(sections[i])) {
+            AudioBiquadCascadeAdd(&cascade, sections[i]);
+        }
+    }
+    AudioBiquadCascadeProcessFloat(&cascade, pIn, pOut, frameCount, indx);
+}
+
+void AudioEqualizerSetBlockMode(AUDIO_EQUALIZER * pEqualizer, bool enable) {
+	int i = 0;
+	int numSections = 0;
+	AudioBiquadFilter *sections[MAX_CASCADE_SECTIONS];
+    numSections = AudioEqualizerGetSections(pEqualizer, sections);
+    for (i = 0; i < numSections; ++i) {
+        AudioBiquadSetBlockMode(sections[i], enable);
     }
-    AudioShelvingDisable(&(pEqualizer->mpHighShelf), immediate);///high
+}
+
+void AudioEqualizerSetParallelMode(AUDIO_EQUALIZER * pEqualizer, bool enable, double maxError) {
+    pEqualizer->mParallelEnabled = enable;
+    pEqualizer->mMaxParallelError = maxError;
+}
+
+double AudioEqualizerGetParallelError(AUDIO_EQUALIZER * pEqualizer) {
+    return pEqualizer->mParallelError;
+}
+
+void AudioEqualizerEnable(AUDIO_EQUALIZER * pEqualizer, bool immediate) {
+	bool active[MAX_CASCADE_SECTIONS];
+    pEqualizer->mEnabled = true;
+    AudioEqualizerUpdateCoefs(pEqualizer);
+    AudioEqualizerGetActive(pEqualizer, active);
+    AudioEqualizerUpdateBands(pEqualizer, active, immediate);
+    AudioEqualizerDropParallel(pEqualizer);
+}
+
+void AudioEqualizerDisable(AUDIO_EQUALIZER * pEqualizer, bool immediate) {
+	bool active[MAX_CASCADE_SECTIONS];
+    pEqualizer->mEnabled = false;
+    AudioEqualizerUpdateCoefs(pEqualizer);
+    AudioEqualizerGetActive(pEqualizer, active);
+    AudioEqualizerUpdateBands(pEqualizer, active, immediate);
+    AudioEqualizerDropParallel(pEqualizer);
 }
 
 int AudioEqualizerGetMostRelevantBand(AUDIO_EQUALIZER * pEqualizer, uint32_t targetFreq) {
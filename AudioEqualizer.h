@@ -20,6 +20,8 @@
 #include "AudioCommon.h"
 #include "AudioShelvingFilter.h"
 #include "AudioPeakingFilter.h"
+#include "AudioBiquadCascade.h"
+#include "AudioBiquadParallel.h"
 
 // A parametric audio equalizer. Supports an arbitrary number of bands and
 // presets.
@@ -34,6 +36,8 @@
 // preset.
 ///static const int PRESET_CUSTOM = -1;
 #define PRESET_CUSTOM  (-1)
+// Max number of bands, including the two shelves: one cascade section each.
+#define MAX_EQ_BANDS  MAX_CASCADE_SECTIONS
 
 typedef struct _BAND_CONFIG_ {
 	// Gain in millibel.
@@ -53,6 +57,28 @@ typedef struct _PRESET_CONFIG_ {
 	const BAND_CONFIG * bandConfigs;
 }PRESET_CONFIG;
 
+// Number of slots of the settings handoff: one being written by the control
+// thread, one published, and one in use by the audio thread.
+#define SETTINGS_SLOTS  (3)
+// Flags the published slot, until the audio thread picks it up.
+#define SETTINGS_FRESH  (4)
+
+// All the bits of AUDIO_EQUALIZER::mDirtyBands.
+#define ALL_BANDS_DIRTY  (0xFFFFFFFFu >> (32 - MAX_EQ_BANDS))
+
+// The settings of the bands, as computed from the parameters by a commit.
+typedef struct _AudioEqualizerSettings_ {
+    // The target coefficients of each band.
+    audio_coef_t mCoefs[MAX_CASCADE_SECTIONS][NUM_COEFS];
+    // Whether each band is processed, rather than bypassed.
+    bool mActive[MAX_CASCADE_SECTIONS];
+    // Whether the coefficients jump to their targets.
+    bool mImmediate;
+    // The parallel form of the bands at these coefficients, none if it is not
+    // selected or not within its error bound.
+    AudioBiquadExpansion mExpansion;
+}AudioEqualizerSettings;
+
 typedef struct  _AUDIO_EQUALIZER_{
     // Configuration of a single band.
 	BAND_CONFIG BandConfig;
@@ -73,13 +99,157 @@ typedef struct  _AUDIO_EQUALIZER_{
     AudioShelvingFilter mpLowShelf;
     // The high-shelving filter.
     AudioShelvingFilter mpHighShelf;
-    // An array of size mNumPeaking of peaking filters.
-    AudioPeakingFilter mpPeakingFilters[3];
+    // The mNumPeaking peaking filters, contiguous, in storage owned by the
+    // client (see _AudioEqualizer()), so that an EQ only takes room for the
+    // bands it has.
+    AudioPeakingFilter * mpPeakingFilters;
+    // Whether the client enabled the EQ. While enabled, the bands with a gain
+    // of 0 mB are flat, and are bypassed rather than processed.
+    bool mEnabled;
+    // Gain applied on top of the bands, AUDIO_COEF_ONE for unity. It is folded
+    // into the numerator of the last band, so it costs nothing per sample.
+    audio_coef_t mVolume;
+    // The parallel form of the bands, for the floating point engine.
+    AudioBiquadParallel mParallel;
+    // Whether the client selected the parallel form, and the max error bound
+    // it accepts. Control thread only, like the parameters of the bands.
+    bool mParallelEnabled;
+    double mMaxParallelError;
+    // Error bound of the parallel form for the settings last computed.
+    double mParallelError;
+    // Bands whose parameters were set since their coefficients were last
+    // computed, as a bit-mask.
+    uint32_t mDirtyBands;
+    // The coefficients last computed for each band.
+    audio_coef_t mBandCoefs[MAX_CASCADE_SECTIONS][NUM_COEFS];
+    // Handoff of the settings from the control thread to the audio thread, a
+    // triple buffer: mSettings[mBackSlot] belongs to the control thread,
+    // mSettings[mFrontSlot] to the audio thread, and the slots are swapped
+    // with the published one through the atomic mPublished, which holds its
+    // index, with SETTINGS_FRESH until the audio thread picks it up.
+    AudioEqualizerSettings mSettings[SETTINGS_SLOTS];
+    int mBackSlot;
+    int mFrontSlot;
+    int mPublished;
+    // Number of calls to AudioEqualizerPublish(). Control thread only.
+    uint32_t mNumPublished;
 
 }AUDIO_EQUALIZER;
 
+// Constructs an EQ of bandsNum bands, from 2 (the shelves) to MAX_EQ_BANDS.
+// pPeakingFilters is room for its bandsNum - 2 peaking filters, which the
+// client keeps for the lifetime of the EQ. presets, of mNumPresets entries,
+// may be NULL.
+void _AudioEqualizer(AUDIO_EQUALIZER * pEqualizer, int32_t bandsNum, int nChannels, int sampleRate,
+	const PRESET_CONFIG * presets, int32_t mNumPresets, AudioPeakingFilter * pPeakingFilters);
+
+// Sets the gain applied on top of the bands, from 0 to AUDIO_COEF_ONE (unity),
+// which takes effect on the next commit. It scales the b coefficients of the
+// last band, and goes through a transition like any other change of
+// coefficients for a commit that is not immediate. A last band that is flat,
+// or an EQ that is disabled, leaves a plain gain there.
+void AudioEqualizerSetVolume(AUDIO_EQUALIZER * pEqualizer, audio_coef_t volume);
+
+// Returns the number of bands, set at construction: from 2 (the shelves) to
+// MAX_EQ_BANDS.
+int AudioEqualizerGetNumBands(AUDIO_EQUALIZER * pEqualizer);
+
+// Parameters of a band, from 0 to AudioEqualizerGetNumBands() - 1, which take
+// effect on the next commit: gain in millibels, center frequency in
+// millihertz, and bandwidth in cents. The shelves have no bandwidth: it is
+// ignored when set, and 0 when read. Setting a parameter selects
+// PRESET_CUSTOM.
+void AudioEqualizerSetGain(AUDIO_EQUALIZER * pEqualizer, int band, int32_t millibel);
+
+void AudioEqualizerSetFrequency(AUDIO_EQUALIZER * pEqualizer, int band, uint32_t millihertz);
+
+void AudioEqualizerSetBandwidth(AUDIO_EQUALIZER * pEqualizer, int band, uint32_t cents);
+
+int32_t AudioEqualizerGetGain(AUDIO_EQUALIZER * pEqualizer, int band);
+
+uint32_t AudioEqualizerGetFrequency(AUDIO_EQUALIZER * pEqualizer, int band);
+
+uint32_t AudioEqualizerGetBandwidth(AUDIO_EQUALIZER * pEqualizer, int band);
+
+// Presets, from 0 to AudioEqualizerGetNumPresets() - 1. AudioEqualizerSetPreset()
+// sets the parameters of all the bands; AudioEqualizerGetPreset() returns
+// PRESET_CUSTOM once a band was set since.
+int AudioEqualizerGetNumPresets(AUDIO_EQUALIZER * pEqualizer);
+
+int AudioEqualizerGetPreset(AUDIO_EQUALIZER * pEqualizer);
+
+void AudioEqualizerSetPreset(AUDIO_EQUALIZER * pEqualizer, int preset);
+
 void AudioEqualizerProcess(AUDIO_EQUALIZER * pEqualizer, 
 	const audio_sample_t * pIn, audio_sample_t * pOut, int frameCount, effect_sound_track indx);
 
+// Processes the first numTracks tracks of a mono EQ at once, each from and to
+// its own buffer: pIn[indx] and pOut[indx] for track indx. Same as one
+// AudioEqualizerProcess() per track. See AudioBiquadCascadeProcessPlanar().
+void AudioEqualizerProcessPlanar(AUDIO_EQUALIZER * pEqualizer,
+	const audio_sample_t * const pIn[], audio_sample_t * const pOut[], int frameCount, int numTracks);
+
+// Same as AudioEqualizerCommit(), for a control thread running concurrently
+// with the audio thread: the settings of the bands are computed here from the
+// parameters, which the audio thread never reads, and published for
+// AudioEqualizerFetch() to apply between two blocks. Lock-free, for a single
+// control thread. Settings that were not picked up yet are replaced.
+void AudioEqualizerPublish(AUDIO_EQUALIZER * pEqualizer, bool immediate);
+
+// Returns the number of calls to AudioEqualizerPublish() since construction.
+uint32_t AudioEqualizerGetNumPublished(AUDIO_EQUALIZER * pEqualizer);
+
+// Applies the settings last published by AudioEqualizerPublish(), if they
+// were not applied yet, and returns true if so. Called by the audio thread
+// before processing a block; lock-free, and allocates nothing.
+bool AudioEqualizerFetch(AUDIO_EQUALIZER * pEqualizer);
+
+// Same as AudioEqualizerProcess(), on 16 bit samples, with the conversions
+// fused into the processing pass. See AudioBiquadCascadeProcessS16(). The EQ
+// must be steady (see AudioEqualizerIsSteady()). The number of samples clipped
+// is added to *pClipped.
+void AudioEqualizerProcessS16(AUDIO_EQUALIZER * pEqualizer,
+	const int16_t * pIn, int16_t * pOut, int frameCount, effect_sound_track indx, bool accumulate,
+	uint32_t *pClipped);
+
+// Same as AudioEqualizerProcess(), on floating point samples.
+void AudioEqualizerProcessFloat(AUDIO_EQUALIZER * pEqualizer,
+	const audio_sample_float_t * pIn, audio_sample_float_t * pOut, int frameCount, effect_sound_track indx);
+
+// Fills sections with the biquads of all the bands, in processing order, and
+// returns their number. sections must have room for MAX_CASCADE_SECTIONS.
+int AudioEqualizerGetSections(AUDIO_EQUALIZER * pEqualizer, AudioBiquadFilter *sections[]);
+
+// Selects block mode for all the bands (see AudioBiquadBlock.h). Only
+// affects the floating point engine.
+void AudioEqualizerSetBlockMode(AUDIO_EQUALIZER * pEqualizer, bool enable);
+
+// Selects the parallel form of the bands (see AudioBiquadParallel.h) for the
+// floating point engine, whenever its error bound is at most maxError, as a
+// fraction of full scale. Takes effect on the next commit, like the parameters
+// of the bands: the parallel form is computed along with the coefficients, by
+// AudioEqualizerCommit() or AudioEqualizerPublish(), never on the audio thread.
+void AudioEqualizerSetParallelMode(AUDIO_EQUALIZER * pEqualizer, bool enable, double maxError);
+
+// Returns the error bound of the parallel form for the settings last computed
+// by a commit, as a fraction of full scale, or HUGE_VAL if there is none.
+double AudioEqualizerGetParallelError(AUDIO_EQUALIZER * pEqualizer);
+
+// Returns true if every band is bypassed, and a block passes through the EQ
+// untouched.
+bool AudioEqualizerIsBypassed(AUDIO_EQUALIZER * pEqualizer);
+
+// Returns the number of bands that are bypassed, out of
+// AudioEqualizerGetNumBands().
+int AudioEqualizerGetNumBypassed(AUDIO_EQUALIZER * pEqualizer);
+
+// Returns true if the EQ is steady and the delay lines of track indx (of all
+// the channels, for a multi-channel EQ) have decayed to silence: a silent
+// block would come out silent, and can be skipped.
+bool AudioEqualizerIsIdle(AUDIO_EQUALIZER * pEqualizer, effect_sound_track indx);
+
+// Returns true if no band is in a transition (see AudioBiquadIsSteady()).
+bool AudioEqualizerIsSteady(AUDIO_EQUALIZER * pEqualizer);
+
 #endif // AUDIOEQUALIZER_H_
 
@@ -0,0 +1,362 @@
+/*
+ * Copyright 2009, The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include <assert.h>
+#include "AudioEqualizerBatch.h"
+#include "AudioSimd.h"
+
+// Runs the chunk of lanes g to g+width-1 through all the sections.
+typedef void (*batch_kernel)(AudioEqualizerBatch *pBatch, int numSections, int g, int frameCount);
+
+static void batch_process_scalar(AudioEqualizerBatch *pBatch, int numSections, int g, int frameCount) {
+	int f = 0;
+	int s = 0;
+	audio_coef_sample_acc_t acc;
+	audio_sample_t x0, y0;
+	audio_coef_t (*c)[MAX_BATCH_LANES];
+	audio_sample_t (*d)[MAX_BATCH_LANES];
+    for (f = 0; f < frameCount; ++f) {
+        x0 = pBatch->mChunk[f][g];
+        for (s = 0; s < numSections; ++s) {
+            c = pBatch->mCoefs[s];
+            d = pBatch->mDelays[s];
+            acc = mul_coef_sample(c[0][g], x0);
+            acc = mac_coef_sample(c[1][g], d[0][g], acc);
+            acc = mac_coef_sample(c[2][g], d[1][g], acc);
+            acc = mac_coef_sample(c[3][g], d[2][g], acc);
+            acc = mac_coef_sample(c[4][g], d[3][g], acc);
+            y0 = coef_sample_acc_to_sample(acc);
+            d[1][g] = d[0][g];
+            d[0][g] = x0;
+            d[3][g] = d[2][g];
+            d[2][g] = y0;
+            x0 = y0;
+        }
+        pBatch->mChunk[f][g] = x0;
+    }
+}
+
+#ifdef AUDIO_SIMD_X86
+
+// Lanes g to g+3, one per 64-bit lane. See process_multi_x4() in
+// AudioBiquadSimd.c for the arithmetic.
+AUDIO_TARGET("avx2")
+static void batch_process_x4(AudioEqualizerBatch *pBatch, int numSections, int g, int frameCount) {
+	int f = 0;
+	int s = 0;
+	int k = 0;
+	__m256i c[MAX_CASCADE_SECTIONS][NUM_COEFS];
+	__m256i d[MAX_CASCADE_SECTIONS][4];
+	__m256i x0, acc, sign;
+	const __m256i round = _mm256_set1_epi64x(AUDIO_COEF_ONE - 1);
+	const __m256i pack = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+
+    for (s = 0; s < numSections; ++s) {
+        for (k = 0; k < NUM_COEFS; ++k) {
+            c[s][k] = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *) &pBatch->mCoefs[s][k][g]));
+        }
+        for (k = 0; k < 4; ++k) {
+            d[s][k] = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *) &pBatch->mDelays[s][k][g]));
+        }
+    }
+    for (f = 0; f < frameCount; ++f) {
+        x0 = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *) &pBatch->mChunk[f][g]));
+        for (s = 0; s < numSections; ++s) {
+            acc = _mm256_mul_epi32(c[s][0], x0);
+            acc = _mm256_add_epi64(acc, _mm256_mul_epi32(c[s][1], d[s][0]));
+            acc = _mm256_add_epi64(acc, _mm256_mul_epi32(c[s][2], d[s][1]));
+            acc = _mm256_add_epi64(acc, _mm256_mul_epi32(c[s][3], d[s][2]));
+            acc = _mm256_add_epi64(acc, _mm256_mul_epi32(c[s][4], d[s][3]));
+            sign = _mm256_shuffle_epi32(_mm256_srai_epi32(acc, 31), _MM_SHUFFLE(3, 3, 1, 1));
+            acc = _mm256_add_epi64(acc, _mm256_and_si256(sign, round));
+            acc = _mm256_srli_epi64(acc, AUDIO_COEF_PRECISION);
+            d[s][1] = d[s][0];
+            d[s][0] = x0;
+            d[s][3] = d[s][2];
+            d[s][2] = acc;
+            x0 = acc;
+        }
+        _mm_storeu_si128((__m128i *) &pBatch->mChunk[f][g],
+                         _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(x0, pack)));
+    }
+    for (s = 0; s < numSections; ++s) {
+        for (k = 0; k < 4; ++k) {
+            _mm_storeu_si128((__m128i *) &pBatch->mDelays[s][k][g],
+                             _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(d[s][k], pack)));
+        }
+    }
+}
+
+// Lanes g to g+7, one per 64-bit lane. AVX-512 has a 64-bit arithmetic shift
+// and a narrowing conversion, so the rounding and the packing of the result
+// are a couple of instructions each.
+AUDIO_TARGET("avx512f")
+static void batch_process_x8(AudioEqualizerBatch *pBatch, int numSections, int g, int frameCount) {
+	int f = 0;
+	int s = 0;
+	int k = 0;
+	__m512i c[MAX_CASCADE_SECTIONS][NUM_COEFS];
+	__m512i d[MAX_CASCADE_SECTIONS][4];
+	__m512i x0, acc;
+	const __m512i round = _mm512_set1_epi64(AUDIO_COEF_ONE - 1);
+
+    for (s = 0; s < numSections; ++s) {
+        for (k = 0; k < NUM_COEFS; ++k) {
+            c[s][k] = _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i *) &pBatch->mCoefs[s][k][g]));
+        }
+        for (k = 0; k < 4; ++k) {
+            d[s][k] = _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i *) &pBatch->mDelays[s][k][g]));
+        }
+    }
+    for (f = 0; f < frameCount; ++f) {
+        x0 = _mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i *) &pBatch->mChunk[f][g]));
+        for (s = 0; s < numSections; ++s) {
+            acc = _mm512_mul_epi32(c[s][0], x0);
+            acc = _mm512_add_epi64(acc, _mm512_mul_epi32(c[s][1], d[s][0]));
+            acc = _mm512_add_epi64(acc, _mm512_mul_epi32(c[s][2], d[s][1]));
+            acc = _mm512_add_epi64(acc, _mm512_mul_epi32(c[s][3], d[s][2]));
+            acc = _mm512_add_epi64(acc, _mm512_mul_epi32(c[s][4], d[s][3]));
+            acc = _mm512_add_epi64(acc, _mm512_and_si512(_mm512_srai_epi64(acc, 63), round));
+            acc = _mm512_srai_epi64(acc, AUDIO_COEF_PRECISION);
+            d[s][1] = d[s][0];
+            d[s][0] = x0;
+            d[s][3] = d[s][2];
+            d[s][2] = acc;
+            x0 = acc;
+        }
+        _mm256_storeu_si256((__m256i *) &pBatch->mChunk[f][g], _mm512_cvtepi64_epi32(x0));
+    }
+    for (s = 0; s < numSections; ++s) {
+        for (k = 0; k < 4; ++k) {
+            _mm256_storeu_si256((__m256i *) &pBatch->mDelays[s][k][g], _mm512_cvtepi64_epi32(d[s][k]));
+        }
+    }
+}
+
+#endif // AUDIO_SIMD_X86
+
+void AudioEqualizerBatchInit(AudioEqualizerBatch *pBatch, int numLanes) {
+    assert(numLanes == 4 || numLanes == 8 || numLanes == 16);
+    memset(pBatch, 0, sizeof(*pBatch));
+    pBatch->mNumLanes = numLanes;
+}
+
+int AudioEqualizerBatchAdd(AudioEqualizerBatch *pBatch, AUDIO_EQUALIZER *pEqualizer,
+	effect_sound_track indx) {
+
+	int lane = 0;
+    // Lanes are mono, a multi-channel session would not fit in one.
+    assert(pEqualizer->mpLowShelf.mBiquad.mNumChannels == 1);
+    assert(indx >= 0 && indx < MAX_CHANNELS);
+    for (lane = 0; lane < pBatch->mNumLanes; ++lane) {
+        if (pBatch->mpSessions[lane] == NULL) {
+            pBatch->mpSessions[lane] = pEqualizer;
+            pBatch->mTracks[lane] = indx;
+            return lane;
+        }
+    }
+    return -1;
+}
+
+void AudioEqualizerBatchRemove(AudioEqualizerBatch *pBatch, int lane) {
+    assert(lane >= 0 && lane < pBatch->mNumLanes);
+    pBatch->mpSessions[lane] = NULL;
+}
+
+int AudioEqualizerBatchGetNumSessions(AudioEqualizerBatch *pBatch) {
+	int lane = 0;
+	int n = 0;
+    for (lane = 0; lane < pBatch->mNumLanes; ++lane) {
+        if (pBatch->mpSessions[lane] != NULL) {
+            ++n;
+        }
+    }
+    return n;
+}
+
+// Copies the coefficients and delay lines of the sessions in lanes to the
+// batch, and returns the number of sections to run. A lane without a section
+// at some position (a lane not in lanes, a session with fewer bands or a
+// bypassed band) gets the identity there, which passes the samples through
+// unchanged.
+static int batch_gather(AudioEqualizerBatch *pBatch, uint32_t lanes) {
+	int lane = 0;
+	int s = 0;
+	int k = 0;
+	int n = 0;
+	int numSections = 0;
+	int maxSections = 0;
+	AudioBiquadFilter *sections[MAX_CASCADE_SECTIONS];
+	AudioBiquadFilter *pSection;
+	effect_sound_track indx;
+
+    // Only the sections of the session with the most bands are gathered, the
+    // others are padded with identity up to it.
+    for (lane = 0; lane < pBatch->mNumLanes; ++lane) {
+        if (lanes & (1 << lane)) {
+            n = AudioEqualizerGetSections(pBatch->mpSessions[lane], sections);
+            if (n > maxSections) {
+                maxSections = n;
+            }
+        }
+    }
+    for (s = 0; s < maxSections; ++s) {
+        pBatch->mActiveLanes[s] = 0;
+    }
+    for (lane = 0; lane < pBatch->mNumLanes; ++lane) {
+        n = 0;
+        if (lanes & (1 << lane)) {
+            n = AudioEqualizerGetSections(pBatch->mpSessions[lane], sections);
+        }
+        indx = pBatch->mTracks[lane];
+        for (s = 0; s < maxSections; ++s) {
+            pSection = s < n ? sections[s] : NULL;
+            if (pSection != NULL && !AudioBiquadIsBypassed(pSection)) {
+                for (k = 0; k < NUM_COEFS; ++k) {
+                    pBatch->mCoefs[s][k][lane] = pSection->mCoefs[k];
+                }
+                for (k = 0; k < 4; ++k) {
+                    pBatch->mDelays[s][k][lane] = pSection->mDelays[indx][k];
+                }
+                pBatch->mActiveLanes[s] |= 1 << lane;
+                if (s + 1 > numSections) {
+                    numSections = s + 1;
+                }
+            } else {
+                pBatch->mCoefs[s][0][lane] = AUDIO_COEF_ONE;
+                for (k = 1; k < NUM_COEFS; ++k) {
+                    pBatch->mCoefs[s][k][lane] = 0;
+                }
+                for (k = 0; k < 4; ++k) {
+                    pBatch->mDelays[s][k][lane] = 0;
+                }
+            }
+        }
+    }
+    return numSections;
+}
+
+// Writes the delay lines back to the sections that were processed.
+static void batch_scatter(AudioEqualizerBatch *pBatch, uint32_t lanes, int numSections) {
+	int lane = 0;
+	int s = 0;
+	int k = 0;
+	AudioBiquadFilter *sections[MAX_CASCADE_SECTIONS];
+	effect_sound_track indx;
+
+    for (lane = 0; lane < pBatch->mNumLanes; ++lane) {
+        if (!(lanes & (1 << lane))) {
+            continue;
+        }
+        AudioEqualizerGetSections(pBatch->mpSessions[lane], sections);
+        indx = pBatch->mTracks[lane];
+        for (s = 0; s < numSections; ++s) {
+            if (pBatch->mActiveLanes[s] & (1 << lane)) {
+                for (k = 0; k < 4; ++k) {
+                    sections[s]->mDelays[indx][k] = pBatch->mDelays[s][k][lane];
+                }
+            }
+        }
+    }
+}
+
+void AudioEqualizerBatchProcess(AudioEqualizerBatch *pBatch,
+	const audio_sample_t * const pIn[], audio_sample_t * const pOut[], int frameCount) {
+
+	int lane = 0;
+	int g = 0;
+	int f = 0;
+	int pos = 0;
+	int chunk = 0;
+	int width = 1;
+	int numSections = 0;
+	uint32_t usedLanes = 0;
+	uint32_t groupMask = 0;
+	batch_kernel kernel = batch_process_scalar;
+
+    for (lane = 0; lane < pBatch->mNumLanes; ++lane) {
+        if (pBatch->mpSessions[lane] == NULL) {
+            continue;
+        }
+        if (AudioEqualizerIsSteady(pBatch->mpSessions[lane])) {
+            usedLanes |= 1 << lane;
+        } else {
+            // The coefficients of a session in transition ramp from sample
+            // to sample, it sits this block out and is processed on its own.
+            AudioEqualizerProcess(pBatch->mpSessions[lane], pIn[lane], pOut[lane], frameCount,
+                    pBatch->mTracks[lane]);
+        }
+    }
+    if (usedLanes == 0) {
+        return;
+    }
+
+#ifdef AUDIO_SIMD_X86
+    if (pBatch->mNumLanes >= 8 && AudioSimdHasAvx512f()) {
+        kernel = batch_process_x8;
+        width = 8;
+    } else if (AudioSimdHasAvx2()) {
+        kernel = batch_process_x4;
+        width = 4;
+    }
+#endif
+    groupMask = (1 << width) - 1;
+
+    numSections = batch_gather(pBatch, usedLanes);
+    if (numSections == 0) {
+        // Everything is bypassed.
+        for (lane = 0; lane < pBatch->mNumLanes; ++lane) {
+            if ((usedLanes & (1 << lane)) && pIn[lane] != pOut[lane]) {
+                memcpy(pOut[lane], pIn[lane], frameCount * sizeof(audio_sample_t));
+            }
+        }
+        return;
+    }
+
+    for (pos = 0; pos < frameCount; pos += chunk) {
+        chunk = frameCount - pos;
+        if (chunk > BATCH_CHUNK_FRAMES) {
+            chunk = BATCH_CHUNK_FRAMES;
+        }
+        // Interleave, other lanes get silence.
+        for (lane = 0; lane < pBatch->mNumLanes; ++lane) {
+            if (usedLanes & (1 << lane)) {
+                for (f = 0; f < chunk; ++f) {
+                    pBatch->mChunk[f][lane] = pIn[lane][pos + f];
+                }
+            } else {
+                for (f = 0; f < chunk; ++f) {
+                    pBatch->mChunk[f][lane] = 0;
+                }
+            }
+        }
+        for (g = 0; g < pBatch->mNumLanes; g += width) {
+            if (usedLanes & (groupMask << g)) {
+                kernel(pBatch, numSections, g, chunk);
+            }
+        }
+        for (lane = 0; lane < pBatch->mNumLanes; ++lane) {
+            if (usedLanes & (1 << lane)) {
+                for (f = 0; f < chunk; ++f) {
+                    pOut[lane][pos + f] = pBatch->mChunk[f][lane];
+                }
+            }
+        }
+    }
+
+    batch_scatter(pBatch, usedLanes, numSections);
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2009, The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AUDIOEQUALIZERBATCH_H_
+#define AUDIOEQUALIZERBATCH_H_
+
+#include "AudioEqualizer.h"
+
+// A batch of independent equalizer sessions, processed together.
+// The recursion of a biquad is serial in time, so a single stream cannot make
+// use of wide vectors. A batch instead puts one session in each 64-bit vector
+// lane, and runs the whole cascade of all its sessions in a single loop: 4
+// sessions per vector with AVX2, 8 with AVX-512.
+// For the duration of a block, the coefficients and delay lines of all the
+// sessions are copied into structure-of-arrays storage (section, then
+// coefficient or delay, then lane), and the delay lines are written back to
+// the sessions when the block is done. The sessions remain the owners of
+// their state, and can be controlled as usual, or taken out of the batch and
+// processed on their own at any time. The output of each session is
+// bit-exact with AudioEqualizerProcess().
+// All the sessions of a batch process mono blocks of the same size, each from
+// its own buffer.
+// A session in a coefficient transition sits the block out of the vector
+// kernels and is processed on its own, as its coefficients ramp from sample to
+// sample.
+
+// Max number of sessions in a batch.
+#define MAX_BATCH_LANES  (16)
+// Number of frames interleaved across the lanes at a time.
+#define BATCH_CHUNK_FRAMES  (64)
+
+typedef struct _AudioEqualizerBatch_ {
+    // Number of lanes: 4, 8 or 16.
+    int mNumLanes;
+    // The session in each lane, NULL for a free lane.
+    AUDIO_EQUALIZER *mpSessions[MAX_BATCH_LANES];
+    // The track of each session, selecting its delay lines.
+    effect_sound_track mTracks[MAX_BATCH_LANES];
+    // Coefficients of the current block, mCoefs[section][coef][lane].
+    audio_coef_t mCoefs[MAX_CASCADE_SECTIONS][NUM_COEFS][MAX_BATCH_LANES];
+    // Delay lines of the current block, mDelays[section][delay][lane].
+    audio_sample_t mDelays[MAX_CASCADE_SECTIONS][4][MAX_BATCH_LANES];
+    // Lanes in which a section is not bypassed, as a bit-mask per section.
+    uint32_t mActiveLanes[MAX_CASCADE_SECTIONS];
+    // Samples of the current chunk, interleaved across the lanes.
+    audio_sample_t mChunk[BATCH_CHUNK_FRAMES][MAX_BATCH_LANES];
+}AudioEqualizerBatch;
+
+void AudioEqualizerBatchInit(AudioEqualizerBatch *pBatch, int numLanes);
+
+// Adds a mono session to a free lane, returns the lane or -1 if the batch is
+// full.
+int AudioEqualizerBatchAdd(AudioEqualizerBatch *pBatch, AUDIO_EQUALIZER *pEqualizer,
+	effect_sound_track indx);
+
+void AudioEqualizerBatchRemove(AudioEqualizerBatch *pBatch, int lane);
+
+int AudioEqualizerBatchGetNumSessions(AudioEqualizerBatch *pBatch);
+
+// Processes a block of every session in the batch. pIn[lane] and pOut[lane]
+// are the buffers of the session in that lane; they are ignored for free
+// lanes. In-place processing is supported.
+void AudioEqualizerBatchProcess(AudioEqualizerBatch *pBatch,
+	const audio_sample_t * const pIn[], audio_sample_t * const pOut[], int frameCount);
+
+#endif // AUDIOEQUALIZERBATCH_H_
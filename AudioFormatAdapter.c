@@ -1,9 +1,13 @@
 #include "AudioFormatAdapter.h"
+#include "AudioFormatSimd.h"
 #include <string.h>
 #include <assert.h>
 
-static void ConvertInput(AudioFormatAdapter *pFormatAdapter, const int16_t *pIn, uint32_t numSamples);
-static void ConvertOutput(AudioFormatAdapter *pFormatAdapter, int16_t *pOut, uint32_t numSamples);
+static void ConvertInput(AudioFormatAdapter *pFormatAdapter, const void *pIn,
+	audio_sample_t *pOut, uint32_t numSamples);
+static void ConvertOutput(AudioFormatAdapter *pFormatAdapter, const audio_sample_t *pIn,
+	void *pOut, uint32_t numSamples, bool accumulate);
+static void AccumulateBus(const audio_sample_t *pIn, audio_sample_t *pBus, uint32_t numSamples);
 
 void AudioFormatAdapterConfigure(AudioFormatAdapter *pFormatAdapter, AUDIO_EQUALIZER * pEqualizer, 
 				int nChannels, uint8_t pcmFormat, uint32_t behavior) {
@@ -12,6 +16,43 @@ void AudioFormatAdapterConfigure(AudioFormatAdapter *pFormatAdapter, AUDIO_EQUAL
 	pFormatAdapter->mPcmFormat = pcmFormat;
 	pFormatAdapter->mBehavior = behavior;
 	pFormatAdapter->mMaxSamplesPerCall = BUFFER_SIZE / nChannels;
+	pFormatAdapter->mIdle = false;
+	pFormatAdapter->mNumClipped = 0;
+}
+
+static size_t SampleSize(AudioFormatAdapter *pFormatAdapter) {
+    switch (pFormatAdapter->mPcmFormat) {
+    case AUDIO_FORMAT_PCM_16_BIT:
+        return sizeof(int16_t);
+    case AUDIO_FORMAT_PCM_24_BIT_PACKED:
+        return 3;
+    case AUDIO_FORMAT_PCM_FLOAT:
+        return sizeof(audio_sample_float_t);
+    default:
+        return sizeof(int32_t);
+    }
+}
+
+// Returns true if all the samples of a block are zero.
+static bool IsSilent(AudioFormatAdapter *pFormatAdapter, const void *pIn, uint32_t numSamples) {
+	uint32_t i = 0;
+	const uint32_t nSamplesChannels = numSamples * pFormatAdapter->mNumChannels;
+	const uint32_t nBytes = nSamplesChannels * SampleSize(pFormatAdapter);
+    if (pFormatAdapter->mPcmFormat == AUDIO_FORMAT_PCM_FLOAT) {
+        // -0.0f is silent too.
+        for (i = 0; i < nSamplesChannels; ++i) {
+            if (((const audio_sample_float_t *) pIn)[i] != 0.0f) {
+                return false;
+            }
+        }
+    } else {
+        for (i = 0; i < nBytes; ++i) {
+            if (((const uint8_t *) pIn)[i] != 0) {
+                return false;
+            }
+        }
+    }
+    return true;
 }
 
 void AudioFormatAdapterFree(AudioFormatAdapter *pFormatAdapter) {
@@ -21,51 +62,374 @@ void AudioFormatAdapterFree(AudioFormatAdapter *pFormatAdapter) {
     }
 }
 
-void AudioFormatAdapterProcess(AudioFormatAdapter *pFormatAdapter, 
-	const int16_t * pIn, int16_t * pOut, uint32_t numSamples, effect_sound_track indx) {
+static void ProcessFloat(AudioFormatAdapter *pFormatAdapter,
+	const audio_sample_float_t *pIn, audio_sample_float_t *pOut, uint32_t numSamples, effect_sound_track indx) {
+
+	uint32_t i = 0;
+    if (pFormatAdapter->mBehavior == EFFECT_BUFFER_ACCESS_WRITE) {
+        // The host buffers are processed directly.
+        AudioEqualizerProcessFloat(pFormatAdapter->mpProcessor, pIn, pOut, numSamples, indx);
+        return;
+    }
+    // A floating point mix bus is the same as accumulating.
+    assert(pFormatAdapter->mBehavior == EFFECT_BUFFER_ACCESS_ACCUMULATE
+            || pFormatAdapter->mBehavior == EFFECT_BUFFER_ACCESS_ACCUMULATE_WIDE);
+    while (numSamples > 0) {
+        uint32_t numSamplesIter = min(numSamples, pFormatAdapter->mMaxSamplesPerCall);
+        uint32_t nSamplesChannels = numSamplesIter * pFormatAdapter->mNumChannels;
+        AudioEqualizerProcessFloat(pFormatAdapter->mpProcessor, pIn, pFormatAdapter->mFloatBuffer, numSamplesIter, indx);
+        for (i = 0; i < nSamplesChannels; ++i) {
+            pOut[i] += pFormatAdapter->mFloatBuffer[i];
+        }
+        pIn += nSamplesChannels;
+        pOut += nSamplesChannels;
+        numSamples -= numSamplesIter;
+    }
+}
+
+// Passes a block through, when every band of the equalizer is bypassed: a
+// copy, or nothing at all for in-place processing.
+static void ProcessBypass(AudioFormatAdapter *pFormatAdapter,
+	const void *pIn, void *pOut, uint32_t numSamples) {
+
+	uint32_t i = 0;
+	const uint32_t nSamplesChannels = numSamples * pFormatAdapter->mNumChannels;
+    if (pFormatAdapter->mBehavior == EFFECT_BUFFER_ACCESS_WRITE) {
+        if (pIn != pOut) {
+            memcpy(pOut, pIn, nSamplesChannels * SampleSize(pFormatAdapter));
+        }
+        return;
+    }
+    assert(pFormatAdapter->mBehavior == EFFECT_BUFFER_ACCESS_ACCUMULATE
+            || (pFormatAdapter->mBehavior == EFFECT_BUFFER_ACCESS_ACCUMULATE_WIDE
+                && pFormatAdapter->mPcmFormat == AUDIO_FORMAT_PCM_FLOAT));
+    switch (pFormatAdapter->mPcmFormat) {
+    case AUDIO_FORMAT_PCM_FLOAT:
+        for (i = 0; i < nSamplesChannels; ++i) {
+            ((audio_sample_float_t *) pOut)[i] += ((const audio_sample_float_t *) pIn)[i];
+        }
+        break;
+    case AUDIO_FORMAT_PCM_16_BIT:
+        for (i = 0; i < nSamplesChannels; ++i) {
+            ((int16_t *) pOut)[i] += ((const int16_t *) pIn)[i];
+        }
+        break;
+    case AUDIO_FORMAT_PCM_24_BIT_PACKED:
+        for (i = 0; i < nSamplesChannels; ++i) {
+            pack_s23((uint8_t *) pOut + 3 * i,
+                    unpack_s23((uint8_t *) pOut + 3 * i) + unpack_s23((const uint8_t *) pIn + 3 * i));
+        }
+        break;
+    default:
+        for (i = 0; i < nSamplesChannels; ++i) {
+            ((int32_t *) pOut)[i] = (int32_t) ((uint32_t) ((int32_t *) pOut)[i]
+                    + (uint32_t) ((const int32_t *) pIn)[i]);
+        }
+        break;
+    }
+}
+
+// Processes a block in fixed point, and adds it to a mix bus of
+// audio_sample_t, without clipping.
+static void ProcessWide(AudioFormatAdapter *pFormatAdapter,
+	const void *pIn, audio_sample_t *pBus, uint32_t numSamples, effect_sound_track indx) {
 
 	while (numSamples > 0) {
-        uint32_t numSamplesIter = min(numSamples, pFormatAdapter->mMaxSamplesPerCall);/// 2048 , 2048
-        uint32_t nSamplesChannels = numSamplesIter * pFormatAdapter->mNumChannels;///mNumChannels = 1
-        if (pFormatAdapter->mPcmFormat == AUDIO_FORMAT_PCM_16_BIT) {
-            ConvertInput(pFormatAdapter, pIn, nSamplesChannels);///left shift 9
-            AudioEqualizerProcess(pFormatAdapter->mpProcessor, pFormatAdapter->mBuffer, pFormatAdapter->mBuffer, numSamplesIter, indx);
-            ConvertOutput(pFormatAdapter, pOut, nSamplesChannels);///right shift 9
+        uint32_t numSamplesIter = min(numSamples, pFormatAdapter->mMaxSamplesPerCall);
+        uint32_t nSamplesChannels = numSamplesIter * pFormatAdapter->mNumChannels;
+        ConvertInput(pFormatAdapter, pIn, pFormatAdapter->mBuffer, nSamplesChannels);
+        AudioEqualizerProcess(pFormatAdapter->mpProcessor, pFormatAdapter->mBuffer, pFormatAdapter->mBuffer, numSamplesIter, indx);
+        AccumulateBus(pFormatAdapter->mBuffer, pBus, nSamplesChannels);
+        pIn = (const uint8_t *) pIn + nSamplesChannels * SampleSize(pFormatAdapter);
+        pBus += nSamplesChannels;
+        numSamples -= numSamplesIter;
+    }
+}
+
+// Processes a block in place, when its samples have the size of
+// audio_sample_t: each tile is converted, processed and converted back in the
+// host buffer, where it stays in the cache, and the intermediate buffer is not
+// used at all.
+static void ProcessInPlace(AudioFormatAdapter *pFormatAdapter,
+	void *pInOut, uint32_t numSamples, effect_sound_track indx) {
+
+	audio_sample_t *pTile = pInOut;
+    assert(SampleSize(pFormatAdapter) == sizeof(audio_sample_t));
+	while (numSamples > 0) {
+        uint32_t numSamplesIter = min(numSamples, pFormatAdapter->mMaxSamplesPerCall);
+        uint32_t nSamplesChannels = numSamplesIter * pFormatAdapter->mNumChannels;
+        ConvertInput(pFormatAdapter, pTile, pTile, nSamplesChannels);
+        AudioEqualizerProcess(pFormatAdapter->mpProcessor, pTile, pTile, numSamplesIter, indx);
+        ConvertOutput(pFormatAdapter, pTile, pTile, nSamplesChannels, false);
+        pTile += nSamplesChannels;
+        numSamples -= numSamplesIter;
+    }
+}
+
+void AudioFormatAdapterProcess(AudioFormatAdapter *pFormatAdapter, 
+	const void * pIn, void * pOut, uint32_t numSamples, effect_sound_track indx) {
+
+    // Silence in, and no tail left in the equalizer: silence out, which
+    // costs nothing in place or when accumulating.
+    pFormatAdapter->mIdle = AudioEqualizerIsIdle(pFormatAdapter->mpProcessor, indx)
+            && IsSilent(pFormatAdapter, pIn, numSamples);
+    if (pFormatAdapter->mIdle) {
+        if (pFormatAdapter->mBehavior == EFFECT_BUFFER_ACCESS_WRITE && pIn != pOut) {
+            memset(pOut, 0, numSamples * pFormatAdapter->mNumChannels * SampleSize(pFormatAdapter));
         }
+        return;
+    }
+    if (pFormatAdapter->mPcmFormat == AUDIO_FORMAT_PCM_FLOAT) {
+        if (AudioEqualizerIsBypassed(pFormatAdapter->mpProcessor)) {
+            ProcessBypass(pFormatAdapter, pIn, pOut, numSamples);
+        } else {
+            ProcessFloat(pFormatAdapter, pIn, pOut, numSamples, indx);
+        }
+        return;
+    }
+    if (pFormatAdapter->mBehavior == EFFECT_BUFFER_ACCESS_ACCUMULATE_WIDE) {
+        // The bus holds audio_sample_t, so even a bypassed block goes through
+        // the conversion.
+        ProcessWide(pFormatAdapter, pIn, pOut, numSamples, indx);
+        return;
+    }
+    if (AudioEqualizerIsBypassed(pFormatAdapter->mpProcessor)) {
+        ProcessBypass(pFormatAdapter, pIn, pOut, numSamples);
+        return;
+    }
+    if (pFormatAdapter->mPcmFormat == AUDIO_FORMAT_PCM_16_BIT
+            && AudioEqualizerIsSteady(pFormatAdapter->mpProcessor)) {
+        // 16 bit samples are converted on the fly, with no intermediate
+        // buffer. During coefficient transitions the bands are run one by
+        // one, which needs the buffer.
+        AudioEqualizerProcessS16(pFormatAdapter->mpProcessor, pIn, pOut, numSamples, indx,
+                pFormatAdapter->mBehavior == EFFECT_BUFFER_ACCESS_ACCUMULATE,
+                &pFormatAdapter->mNumClipped);
+        return;
+    }
+    if (pFormatAdapter->mPcmFormat == AUDIO_FORMAT_PCM_8_24_BIT
+            && pFormatAdapter->mBehavior == EFFECT_BUFFER_ACCESS_WRITE) {
+        // 8.24 is the format of audio_sample_t: the host buffers are
+        // processed directly.
+        AudioEqualizerProcess(pFormatAdapter->mpProcessor, pIn, pOut, numSamples, indx);
+        return;
+    }
+    if (pFormatAdapter->mPcmFormat == AUDIO_FORMAT_PCM_32_BIT
+            && pFormatAdapter->mBehavior == EFFECT_BUFFER_ACCESS_WRITE && pIn == pOut) {
+        ProcessInPlace(pFormatAdapter, pOut, numSamples, indx);
+        return;
+    }
+	while (numSamples > 0) {
+        uint32_t numSamplesIter = min(numSamples, pFormatAdapter->mMaxSamplesPerCall);
+        uint32_t nSamplesChannels = numSamplesIter * pFormatAdapter->mNumChannels;
+        ConvertInput(pFormatAdapter, pIn, pFormatAdapter->mBuffer, nSamplesChannels);
+        AudioEqualizerProcess(pFormatAdapter->mpProcessor, pFormatAdapter->mBuffer, pFormatAdapter->mBuffer, numSamplesIter, indx);
+        ConvertOutput(pFormatAdapter, pFormatAdapter->mBuffer, pOut, nSamplesChannels,
+                pFormatAdapter->mBehavior == EFFECT_BUFFER_ACCESS_ACCUMULATE);
+        pIn = (const uint8_t *) pIn + nSamplesChannels * SampleSize(pFormatAdapter);
+        pOut = (uint8_t *) pOut + nSamplesChannels * SampleSize(pFormatAdapter);
         numSamples -= numSamplesIter;
     }
 }
 
-static void ConvertInput(AudioFormatAdapter *pFormatAdapter, const int16_t *pIn, uint32_t numSamples) {
-	if (pFormatAdapter->mPcmFormat == AUDIO_FORMAT_PCM_16_BIT) {
+// Processes the tracks of a planar block one at a time.
+static void ProcessTracks(AudioFormatAdapter *pFormatAdapter,
+	const void * const pIn[], void * const pOut[], uint32_t numSamples, int numTracks) {
+
+	int t = 0;
+	bool idle = true;
+    for (t = 0; t < numTracks; ++t) {
+        AudioFormatAdapterProcess(pFormatAdapter, pIn[t], pOut[t], numSamples, (effect_sound_track) t);
+        idle = idle && pFormatAdapter->mIdle;
+    }
+    pFormatAdapter->mIdle = idle;
+}
+
+void AudioFormatAdapterProcessPlanar(AudioFormatAdapter *pFormatAdapter,
+	const void * const pIn[], void * const pOut[], uint32_t numSamples, int numTracks) {
+
+	int t = 0;
+	uint32_t done = 0;
+	const audio_sample_t *pTileIn[MAX_CHANNELS];
+	audio_sample_t *pTileOut[MAX_CHANNELS];
+	const uint32_t maxSamplesPerTile = BUFFER_SIZE / numTracks;
+	const size_t sampleSize = SampleSize(pFormatAdapter);
+
+    assert(pFormatAdapter->mNumChannels == 1);
+    assert(numTracks > 0 && numTracks <= MAX_CHANNELS);
+    if (pFormatAdapter->mPcmFormat == AUDIO_FORMAT_PCM_FLOAT
+            || pFormatAdapter->mBehavior == EFFECT_BUFFER_ACCESS_ACCUMULATE_WIDE
+            || AudioEqualizerIsBypassed(pFormatAdapter->mpProcessor)
+            || !AudioEqualizerIsSteady(pFormatAdapter->mpProcessor)) {
+        // Nothing to gain from running the tracks side by side: the floating
+        // point engine vectorizes within a track, and the other cases do
+        // little or no filtering, or ramp the coefficients per track.
+        ProcessTracks(pFormatAdapter, pIn, pOut, numSamples, numTracks);
+        return;
+    }
+    pFormatAdapter->mIdle = true;
+    for (t = 0; t < numTracks && pFormatAdapter->mIdle; ++t) {
+        pFormatAdapter->mIdle = AudioEqualizerIsIdle(pFormatAdapter->mpProcessor, (effect_sound_track) t)
+                && IsSilent(pFormatAdapter, pIn[t], numSamples);
+    }
+    if (pFormatAdapter->mIdle) {
+        for (t = 0; t < numTracks; ++t) {
+            if (pFormatAdapter->mBehavior == EFFECT_BUFFER_ACCESS_WRITE && pIn[t] != pOut[t]) {
+                memset(pOut[t], 0, numSamples * sampleSize);
+            }
+        }
+        return;
+    }
+    if (pFormatAdapter->mPcmFormat == AUDIO_FORMAT_PCM_8_24_BIT
+            && pFormatAdapter->mBehavior == EFFECT_BUFFER_ACCESS_WRITE) {
+        AudioEqualizerProcessPlanar(pFormatAdapter->mpProcessor,
+                (const audio_sample_t * const *) pIn, (audio_sample_t * const *) pOut,
+                numSamples, numTracks);
+        return;
+    }
+    // The intermediate buffer is split into one tile per track.
+    for (t = 0; t < numTracks; ++t) {
+        pTileIn[t] = pTileOut[t] = pFormatAdapter->mBuffer + t * maxSamplesPerTile;
+    }
+    while (done < numSamples) {
+        uint32_t numSamplesIter = min(numSamples - done, maxSamplesPerTile);
+        for (t = 0; t < numTracks; ++t) {
+            ConvertInput(pFormatAdapter, (const uint8_t *) pIn[t] + done * sampleSize, pTileOut[t],
+                    numSamplesIter);
+        }
+        AudioEqualizerProcessPlanar(pFormatAdapter->mpProcessor, pTileIn, pTileOut, numSamplesIter,
+                numTracks);
+        for (t = 0; t < numTracks; ++t) {
+            ConvertOutput(pFormatAdapter, pTileOut[t], (uint8_t *) pOut[t] + done * sampleSize,
+                    numSamplesIter, pFormatAdapter->mBehavior == EFFECT_BUFFER_ACCESS_ACCUMULATE);
+        }
+        done += numSamplesIter;
+    }
+}
+
+size_t AudioFormatAdapterGetFrameSize(AudioFormatAdapter *pFormatAdapter, bool output) {
+    if (output && pFormatAdapter->mBehavior == EFFECT_BUFFER_ACCESS_ACCUMULATE_WIDE
+            && pFormatAdapter->mPcmFormat != AUDIO_FORMAT_PCM_FLOAT) {
+        return pFormatAdapter->mNumChannels * sizeof(audio_sample_t);
+    }
+    return pFormatAdapter->mNumChannels * SampleSize(pFormatAdapter);
+}
+
+bool AudioFormatAdapterIsIdle(AudioFormatAdapter *pFormatAdapter) {
+    return pFormatAdapter->mIdle;
+}
+
+uint32_t AudioFormatAdapterTakeNumClipped(AudioFormatAdapter *pFormatAdapter) {
+	uint32_t numClipped = pFormatAdapter->mNumClipped;
+    pFormatAdapter->mNumClipped = 0;
+    return numClipped;
+}
+
+void AudioFormatAdapterNarrowBus(AudioFormatAdapter *pFormatAdapter,
+	const void *pBus, void *pOut, uint32_t numSamples) {
+
+	const uint32_t nSamplesChannels = numSamples * pFormatAdapter->mNumChannels;
+    if (pFormatAdapter->mPcmFormat == AUDIO_FORMAT_PCM_FLOAT) {
+        if (pBus != pOut) {
+            memcpy(pOut, pBus, nSamplesChannels * sizeof(audio_sample_float_t));
+        }
+        return;
+    }
+    // Every output sample is narrower than its bus sample, so converting in
+    // place is safe.
+    ConvertOutput(pFormatAdapter, pBus, pOut, nSamplesChannels, false);
+}
+
+// The conversions go to the vector kernels of AudioFormatSimd.h first, and
+// the scalar loops, which are the reference, take the samples left over.
+// Both convert in place, when the samples on either side have the same size,
+// or when narrowing a mix bus.
+
+static void ConvertInput(AudioFormatAdapter *pFormatAdapter, const void *pIn,
+	audio_sample_t * pOut, uint32_t numSamples) {
+	uint32_t i = 0;
+	switch (pFormatAdapter->mPcmFormat) {
+	case AUDIO_FORMAT_PCM_16_BIT: {
 		const int16_t * pIn16 = pIn;
-		audio_sample_t * pOut = pFormatAdapter->mBuffer;
-		while (numSamples-- > 0) {
-			*(pOut++) = s15_to_audio_sample_t(*(pIn16++));///left shift 9 bit for *(pIn16++)
+		for (i = AudioFormatSimdFromS15(pIn16, pOut, numSamples); i < numSamples; ++i) {
+			pOut[i] = s15_to_audio_sample_t(pIn16[i]);///left shift 9 bit
 		}
-	} else {///AUDIO_FORMAT_PCM_8_24_BIT
+	} break;
+	case AUDIO_FORMAT_PCM_8_24_BIT: {
+		const int32_t * pIn32 = pIn;
+		for (i = 0; i < numSamples; ++i) {
+			pOut[i] = s7_24_to_audio_sample_t(pIn32[i]);
+		}
+	} break;
+	case AUDIO_FORMAT_PCM_32_BIT: {
+		const int32_t * pIn32 = pIn;
+		for (i = AudioFormatSimdFromS31(pIn32, pOut, numSamples); i < numSamples; ++i) {
+			pOut[i] = s31_to_audio_sample_t(pIn32[i]);
+		}
+	} break;
+	case AUDIO_FORMAT_PCM_24_BIT_PACKED: {
+		const uint8_t * pIn8 = pIn;
+		for (i = 0; i < numSamples; ++i) {
+			pOut[i] = s23_to_audio_sample_t(unpack_s23(pIn8 + 3 * i));
+		}
+	} break;
+	default:
 		assert(false);
+		break;
 	}
 }
 
-static void ConvertOutput(AudioFormatAdapter *pFormatAdapter, int16_t *pOut, uint32_t numSamples) {
-	if (pFormatAdapter->mPcmFormat == AUDIO_FORMAT_PCM_16_BIT) {
-		const audio_sample_t * pIn = pFormatAdapter->mBuffer;
+// Stores a sample converted to the output format, or adds it to the output.
+#define STORE_OUTPUT(out, sample, accumulate) \
+	((out) = (accumulate) ? (out) + (sample) : (sample))
+
+static void ConvertOutput(AudioFormatAdapter *pFormatAdapter, const audio_sample_t *pIn,
+	void *pOut, uint32_t numSamples, bool accumulate) {
+	uint32_t i = 0;
+	switch (pFormatAdapter->mPcmFormat) {
+	case AUDIO_FORMAT_PCM_16_BIT: {
 		int16_t * pOut16 = pOut;
-		if (pFormatAdapter->mBehavior == EFFECT_BUFFER_ACCESS_WRITE) {
-			while (numSamples-- > 0) {
-				*(pOut16++) = audio_sample_t_to_s15_clip(*(pIn++));///right shift 9 bit for *(pIn16++)
-			}
-		} else if (pFormatAdapter->mBehavior == EFFECT_BUFFER_ACCESS_ACCUMULATE) {
-			while (numSamples-- > 0) {
-				*(pOut16++) += audio_sample_t_to_s15_clip(*(pIn++));///right shift 9 bit for *(pIn16++)
-			}
-		} else {
-			assert(false);
+		uint32_t clipped = 0;
+		for (i = AudioFormatSimdToS15(pIn, pOut16, numSamples, accumulate, &clipped); i < numSamples; ++i) {
+			clipped += audio_sample_t_s15_clips(pIn[i]);
+			STORE_OUTPUT(pOut16[i], audio_sample_t_to_s15_clip(pIn[i]), accumulate);///right shift 9 bit
+		}
+		pFormatAdapter->mNumClipped += clipped;
+	} break;
+	case AUDIO_FORMAT_PCM_8_24_BIT: {
+		int32_t * pOut32 = pOut;
+		for (i = 0; i < numSamples; ++i) {
+			// Accumulated in unsigned arithmetic, so that it wraps without
+			// overflowing.
+			pOut32[i] = (int32_t) ((accumulate ? (uint32_t) pOut32[i] : 0u)
+					+ (uint32_t) audio_sample_t_to_s7_24(pIn[i]));
 		}
-	} else {
+	} break;
+	case AUDIO_FORMAT_PCM_32_BIT: {
+		int32_t * pOut32 = pOut;
+		for (i = AudioFormatSimdToS31(pIn, pOut32, numSamples, accumulate); i < numSamples; ++i) {
+			// Accumulated in unsigned arithmetic, so that it wraps like the
+			// other formats.
+			pOut32[i] = (int32_t) ((accumulate ? (uint32_t) pOut32[i] : 0u)
+					+ (uint32_t) audio_sample_t_to_s31_clip(pIn[i]));
+		}
+	} break;
+	case AUDIO_FORMAT_PCM_24_BIT_PACKED: {
+		uint8_t * pOut8 = pOut;
+		for (i = 0; i < numSamples; ++i) {
+			pack_s23(pOut8 + 3 * i, (accumulate ? unpack_s23(pOut8 + 3 * i) : 0)
+					+ audio_sample_t_to_s23_clip(pIn[i]));
+		}
+	} break;
+	default:
 		assert(false);
+		break;
 	}
 }
 
-
+static void AccumulateBus(const audio_sample_t *pIn, audio_sample_t *pBus, uint32_t numSamples) {
+	uint32_t i = 0;
+	for (i = AudioFormatSimdAccumulate(pIn, pBus, numSamples); i < numSamples; ++i) {
+		pBus[i] = (audio_sample_t) ((uint32_t) pBus[i] + (uint32_t) pIn[i]);
+	}
+}
@@ -22,7 +22,13 @@
 #include "AudioEqualizer.h"
 
 #define min(x,y) (((x) < (y)) ? (x) : (y))
-#define BUFFER_SIZE (15834698/2)
+// Size of the intermediate buffer, in samples (all channels). Blocks larger
+// than that are processed in tiles, so the buffer stays in the L1 cache
+// between conversion and processing. A multiple of the number of channels
+// times BIQUAD_BLOCK_SIZE.
+#ifndef BUFFER_SIZE
+#define BUFFER_SIZE (1024)
+#endif
 
 typedef struct _AudioFormatAdapter_ {
     // The underlying processor.
@@ -33,12 +39,22 @@ typedef struct _AudioFormatAdapter_ {
     uint8_t mPcmFormat;
     // The desired buffer behavior.
     uint32_t mBehavior;
-    // An intermediate buffer for processing.
-    audio_sample_t mBuffer[BUFFER_SIZE];
+    // An intermediate buffer for processing. Holds floating point samples
+    // when the PCM format is AUDIO_FORMAT_PCM_FLOAT.
+    union {
+        audio_sample_t mBuffer[BUFFER_SIZE];
+        audio_sample_float_t mFloatBuffer[BUFFER_SIZE];
+    };
     // The buffer size, divided by the number of channels - represents the
     // maximum number of multi-channel samples that can be stored in the
     // intermediate buffer.
     size_t mMaxSamplesPerCall;
+    // Whether the last block was skipped: it was silent, and the equalizer
+    // had no tail left.
+    bool mIdle;
+    // Number of 16 bit output samples clipped since the last call to
+    // AudioFormatAdapterTakeNumClipped().
+    uint32_t mNumClipped;
 }AudioFormatAdapter;
 
 void AudioFormatAdapterConfigure(AudioFormatAdapter *pFormatAdapter, AUDIO_EQUALIZER * pEqualizer, 
@@ -47,8 +63,50 @@ void AudioFormatAdapterConfigure(AudioFormatAdapter *pFormatAdapter, AUDIO_EQUAL
 void AudioFormatAdapterFree(AudioFormatAdapter *pFormatAdapter);
 
 
+// Processes numSamples frames in the configured PCM format. Floating point
+// samples go to the floating point engine of the equalizer, without any
+// conversion, and so do 8.24 samples (the format of audio_sample_t) to the
+// fixed point engine when writing. Other formats (16 bit, 32 bit, and packed
+// 24 bit, all little-endian) are converted to and from audio_sample_t, with
+// clipping on the way out.
+// pIn and pOut are either the same buffer, which is then processed in place
+// without any intermediate copy whenever the format allows, or do not overlap.
 void AudioFormatAdapterProcess(AudioFormatAdapter *pFormatAdapter, 
-	const int16_t * pIn, int16_t * pOut, uint32_t numSamples, effect_sound_track indx);
+	const void * pIn, void * pOut, uint32_t numSamples, effect_sound_track indx);
+
+// Processes numSamples frames of numTracks tracks of a mono session at once,
+// each from and to its own buffer: pIn[indx] and pOut[indx] for track indx.
+// Same as one AudioFormatAdapterProcess() per track, without interleaving a
+// planar source, and with the tracks of the fixed point formats running side
+// by side in vector lanes. See AudioEqualizerProcessPlanar(). The block is
+// idle if all its tracks are.
+void AudioFormatAdapterProcessPlanar(AudioFormatAdapter *pFormatAdapter,
+	const void * const pIn[], void * const pOut[], uint32_t numSamples, int numTracks);
+
+// Returns the size of a frame of the input buffers, or of the output buffers,
+// in bytes.
+size_t AudioFormatAdapterGetFrameSize(AudioFormatAdapter *pFormatAdapter, bool output);
+
+// Returns true if the last block was silence in and out, and was skipped.
+// An idle session produces no output of its own until its input is not
+// silent anymore.
+bool AudioFormatAdapterIsIdle(AudioFormatAdapter *pFormatAdapter);
+
+// Returns the number of samples clipped by the conversion to 16 bits (see
+// audio_sample_t_s15_clips()) since the last call, by the processing or by
+// AudioFormatAdapterNarrowBus(). Only the 16 bit format is counted.
+uint32_t AudioFormatAdapterTakeNumClipped(AudioFormatAdapter *pFormatAdapter);
+
+// With EFFECT_BUFFER_ACCESS_ACCUMULATE_WIDE, the output of
+// AudioFormatAdapterProcess() is added without clipping to a mix bus, instead
+// of a buffer in the configured format: audio_sample_t samples (8.24, which
+// leaves room for 128 full-scale sessions) for the fixed point formats,
+// floating point samples for AUDIO_FORMAT_PCM_FLOAT. Many sessions with the
+// same configuration mix into the same bus, which is then converted to the
+// configured format, with clipping, once for all of them by this function.
+// pOut may be pBus.
+void AudioFormatAdapterNarrowBus(AudioFormatAdapter *pFormatAdapter,
+	const void *pBus, void *pOut, uint32_t numSamples);
 
 #endif // AUDIOFORMATADAPTER_H_
 
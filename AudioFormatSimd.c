@@ -0,0 +1,281 @@
+/*
+**
+** Copyright 2009, The Android Open Source Project
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include "AudioFormatSimd.h"
+#include "AudioSimd.h"
+
+#ifdef AUDIO_SIMD_X86
+
+// The S15 output is rounded as by audio_sample_t_to_s15() in two steps,
+// ((x >> 8) + 1) >> 1, which is the same as (x + (1 << 8)) >> 9 but cannot
+// overflow, and clipped by the saturating pack, which is the same as
+// audio_sample_t_to_s15_clip(). The rounded samples out of the S15 range are
+// counted on the way, as by audio_sample_t_s15_clips(): the all-ones masks of
+// the compares are subtracted from a vector of counts, which is summed up at
+// the end.
+// The S31 output is clamped to [-(1 << 24), 1 << 24] before the shift. The
+// upper bound shifts to 1 << 31, which wraps around to INT32_MIN, and is
+// moved to INT32_MAX by adding the all-ones mask of the compare.
+
+AUDIO_TARGET("sse2")
+static int from_s15_x8(const int16_t *pIn, audio_sample_t *pOut, int numSamples) {
+	int i = 0;
+	__m128i x;
+    for (i = 0; i + 8 <= numSamples; i += 8) {
+        x = _mm_loadu_si128((const __m128i *) (pIn + i));
+        // The sample in the high half of each 32-bit lane, shifted back down.
+        _mm_storeu_si128((__m128i *) (pOut + i),
+                _mm_srai_epi32(_mm_unpacklo_epi16(_mm_setzero_si128(), x), 16 - 9));
+        _mm_storeu_si128((__m128i *) (pOut + i + 4),
+                _mm_srai_epi32(_mm_unpackhi_epi16(_mm_setzero_si128(), x), 16 - 9));
+    }
+    return i;
+}
+
+AUDIO_TARGET("sse2")
+static __m128i round_s15_x4(__m128i x) {
+    return _mm_srai_epi32(_mm_add_epi32(_mm_srai_epi32(x, 8), _mm_set1_epi32(1)), 1);
+}
+
+// -1 in each lane where the rounded sample r is out of the S15 range, 0
+// elsewhere.
+AUDIO_TARGET("sse2")
+static __m128i clips_s15_x4(__m128i r) {
+    return _mm_or_si128(_mm_cmpgt_epi32(r, _mm_set1_epi32(0x7FFF)),
+                        _mm_cmplt_epi32(r, _mm_set1_epi32(-0x8000)));
+}
+
+AUDIO_TARGET("sse2")
+static uint32_t sum_x4(__m128i x) {
+    x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+    x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+    return (uint32_t) _mm_cvtsi128_si32(x);
+}
+
+AUDIO_TARGET("sse2")
+static int to_s15_x8(const audio_sample_t *pIn, int16_t *pOut, int numSamples, bool accumulate,
+	uint32_t *pClipped) {
+	int i = 0;
+	__m128i r0, r1, y;
+	__m128i clipped = _mm_setzero_si128();
+    for (i = 0; i + 8 <= numSamples; i += 8) {
+        r0 = round_s15_x4(_mm_loadu_si128((const __m128i *) (pIn + i)));
+        r1 = round_s15_x4(_mm_loadu_si128((const __m128i *) (pIn + i + 4)));
+        clipped = _mm_sub_epi32(clipped, clips_s15_x4(r0));
+        clipped = _mm_sub_epi32(clipped, clips_s15_x4(r1));
+        y = _mm_packs_epi32(r0, r1);
+        if (accumulate) {
+            y = _mm_add_epi16(y, _mm_loadu_si128((const __m128i *) (pOut + i)));
+        }
+        _mm_storeu_si128((__m128i *) (pOut + i), y);
+    }
+    *pClipped += sum_x4(clipped);
+    return i;
+}
+
+AUDIO_TARGET("sse2")
+static int from_s31_x4(const int32_t *pIn, audio_sample_t *pOut, int numSamples) {
+	int i = 0;
+    for (i = 0; i + 4 <= numSamples; i += 4) {
+        _mm_storeu_si128((__m128i *) (pOut + i),
+                _mm_srai_epi32(_mm_loadu_si128((const __m128i *) (pIn + i)), 7));
+    }
+    return i;
+}
+
+AUDIO_TARGET("sse2")
+static int to_s31_x4(const audio_sample_t *pIn, int32_t *pOut, int numSamples, bool accumulate) {
+	int i = 0;
+	__m128i x, hi, lo, y;
+	const __m128i upper = _mm_set1_epi32(1 << 24);
+	const __m128i lower = _mm_set1_epi32(-(1 << 24));
+    for (i = 0; i + 4 <= numSamples; i += 4) {
+        x = _mm_loadu_si128((const __m128i *) (pIn + i));
+        // No 32-bit min/max before SSE4.1: select with the compare masks.
+        hi = _mm_cmpgt_epi32(x, _mm_sub_epi32(upper, _mm_set1_epi32(1)));
+        lo = _mm_cmplt_epi32(x, lower);
+        x = _mm_or_si128(_mm_andnot_si128(_mm_or_si128(hi, lo), x),
+                         _mm_or_si128(_mm_and_si128(hi, upper), _mm_and_si128(lo, lower)));
+        y = _mm_add_epi32(_mm_slli_epi32(x, 7), hi);
+        if (accumulate) {
+            y = _mm_add_epi32(y, _mm_loadu_si128((const __m128i *) (pOut + i)));
+        }
+        _mm_storeu_si128((__m128i *) (pOut + i), y);
+    }
+    return i;
+}
+
+AUDIO_TARGET("sse2")
+static int accumulate_x4(const audio_sample_t *pIn, audio_sample_t *pBus, int numSamples) {
+	int i = 0;
+    for (i = 0; i + 4 <= numSamples; i += 4) {
+        _mm_storeu_si128((__m128i *) (pBus + i),
+                _mm_add_epi32(_mm_loadu_si128((const __m128i *) (pBus + i)),
+                              _mm_loadu_si128((const __m128i *) (pIn + i))));
+    }
+    return i;
+}
+
+AUDIO_TARGET("avx2")
+static int from_s15_x16(const int16_t *pIn, audio_sample_t *pOut, int numSamples) {
+	int i = 0;
+    for (i = 0; i + 16 <= numSamples; i += 16) {
+        _mm256_storeu_si256((__m256i *) (pOut + i), _mm256_slli_epi32(
+                _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) (pIn + i))), 9));
+        _mm256_storeu_si256((__m256i *) (pOut + i + 8), _mm256_slli_epi32(
+                _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) (pIn + i + 8))), 9));
+    }
+    return i;
+}
+
+AUDIO_TARGET("avx2")
+static __m256i round_s15_x8(__m256i x) {
+    return _mm256_srai_epi32(_mm256_add_epi32(_mm256_srai_epi32(x, 8), _mm256_set1_epi32(1)), 1);
+}
+
+AUDIO_TARGET("avx2")
+static __m256i clips_s15_x8(__m256i r) {
+    return _mm256_or_si256(_mm256_cmpgt_epi32(r, _mm256_set1_epi32(0x7FFF)),
+                           _mm256_cmpgt_epi32(_mm256_set1_epi32(-0x8000), r));
+}
+
+AUDIO_TARGET("avx2")
+static int to_s15_x16(const audio_sample_t *pIn, int16_t *pOut, int numSamples, bool accumulate,
+	uint32_t *pClipped) {
+	int i = 0;
+	__m256i r0, r1, y;
+	__m256i clipped = _mm256_setzero_si256();
+    for (i = 0; i + 16 <= numSamples; i += 16) {
+        r0 = round_s15_x8(_mm256_loadu_si256((const __m256i *) (pIn + i)));
+        r1 = round_s15_x8(_mm256_loadu_si256((const __m256i *) (pIn + i + 8)));
+        clipped = _mm256_sub_epi32(clipped, clips_s15_x8(r0));
+        clipped = _mm256_sub_epi32(clipped, clips_s15_x8(r1));
+        y = _mm256_packs_epi32(r0, r1);
+        // The pack works within 128-bit lanes.
+        y = _mm256_permute4x64_epi64(y, _MM_SHUFFLE(3, 1, 2, 0));
+        if (accumulate) {
+            y = _mm256_add_epi16(y, _mm256_loadu_si256((const __m256i *) (pOut + i)));
+        }
+        _mm256_storeu_si256((__m256i *) (pOut + i), y);
+    }
+    *pClipped += sum_x4(_mm_add_epi32(_mm256_castsi256_si128(clipped),
+                                      _mm256_extracti128_si256(clipped, 1)));
+    return i;
+}
+
+AUDIO_TARGET("avx2")
+static int from_s31_x8(const int32_t *pIn, audio_sample_t *pOut, int numSamples) {
+	int i = 0;
+    for (i = 0; i + 8 <= numSamples; i += 8) {
+        _mm256_storeu_si256((__m256i *) (pOut + i),
+                _mm256_srai_epi32(_mm256_loadu_si256((const __m256i *) (pIn + i)), 7));
+    }
+    return i;
+}
+
+AUDIO_TARGET("avx2")
+static int to_s31_x8(const audio_sample_t *pIn, int32_t *pOut, int numSamples, bool accumulate) {
+	int i = 0;
+	__m256i x, y;
+	const __m256i upper = _mm256_set1_epi32(1 << 24);
+	const __m256i lower = _mm256_set1_epi32(-(1 << 24));
+    for (i = 0; i + 8 <= numSamples; i += 8) {
+        x = _mm256_loadu_si256((const __m256i *) (pIn + i));
+        x = _mm256_min_epi32(_mm256_max_epi32(x, lower), upper);
+        y = _mm256_add_epi32(_mm256_slli_epi32(x, 7), _mm256_cmpeq_epi32(x, upper));
+        if (accumulate) {
+            y = _mm256_add_epi32(y, _mm256_loadu_si256((const __m256i *) (pOut + i)));
+        }
+        _mm256_storeu_si256((__m256i *) (pOut + i), y);
+    }
+    return i;
+}
+
+AUDIO_TARGET("avx2")
+static int accumulate_x8(const audio_sample_t *pIn, audio_sample_t *pBus, int numSamples) {
+	int i = 0;
+    for (i = 0; i + 8 <= numSamples; i += 8) {
+        _mm256_storeu_si256((__m256i *) (pBus + i),
+                _mm256_add_epi32(_mm256_loadu_si256((const __m256i *) (pBus + i)),
+                                 _mm256_loadu_si256((const __m256i *) (pIn + i))));
+    }
+    return i;
+}
+
+#endif // AUDIO_SIMD_X86
+
+int AudioFormatSimdFromS15(const int16_t *pIn, audio_sample_t *pOut, int numSamples) {
+#ifdef AUDIO_SIMD_X86
+    if (AudioSimdHasAvx2()) {
+        return from_s15_x16(pIn, pOut, numSamples);
+    }
+    if (AudioSimdHasSse2()) {
+        return from_s15_x8(pIn, pOut, numSamples);
+    }
+#endif
+    return 0;
+}
+
+int AudioFormatSimdToS15(const audio_sample_t *pIn, int16_t *pOut, int numSamples,
+	bool accumulate, uint32_t *pClipped) {
+#ifdef AUDIO_SIMD_X86
+    if (AudioSimdHasAvx2()) {
+        return to_s15_x16(pIn, pOut, numSamples, accumulate, pClipped);
+    }
+    if (AudioSimdHasSse2()) {
+        return to_s15_x8(pIn, pOut, numSamples, accumulate, pClipped);
+    }
+#endif
+    return 0;
+}
+
+int AudioFormatSimdFromS31(const int32_t *pIn, audio_sample_t *pOut, int numSamples) {
+#ifdef AUDIO_SIMD_X86
+    if (AudioSimdHasAvx2()) {
+        return from_s31_x8(pIn, pOut, numSamples);
+    }
+    if (AudioSimdHasSse2()) {
+        return from_s31_x4(pIn, pOut, numSamples);
+    }
+#endif
+    return 0;
+}
+
+int AudioFormatSimdToS31(const audio_sample_t *pIn, int32_t *pOut, int numSamples,
+	bool accumulate) {
+#ifdef AUDIO_SIMD_X86
+    if (AudioSimdHasAvx2()) {
+        return to_s31_x8(pIn, pOut, numSamples, accumulate);
+    }
+    if (AudioSimdHasSse2()) {
+        return to_s31_x4(pIn, pOut, numSamples, accumulate);
+    }
+#endif
+    return 0;
+}
+
+int AudioFormatSimdAccumulate(const audio_sample_t *pIn, audio_sample_t *pBus, int numSamples) {
+#ifdef AUDIO_SIMD_X86
+    if (AudioSimdHasAvx2()) {
+        return accumulate_x8(pIn, pBus, numSamples);
+    }
+    if (AudioSimdHasSse2()) {
+        return accumulate_x4(pIn, pBus, numSamples);
+    }
+#endif
+    return 0;
+}
@@ -0,0 +1,50 @@
+/*
+**
+** Copyright 2009, The Android Open Source Project
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef ANDROID_AUDIO_FORMAT_SIMD_H
+#define ANDROID_AUDIO_FORMAT_SIMD_H
+
+#include "AudioCommon.h"
+
+// Vectorized kernels for the sample format conversions of the format adapter,
+// 8 16-bit or 4 32-bit samples at a time with SSE2, twice as many with AVX2.
+// Clipping is done by saturating packs and compares rather than branches, and
+// the output is bit-exact with the scalar conversions of AudioCommon.h.
+// Each kernel converts the leading samples of a buffer, and returns how many
+// it converted, which is a multiple of the vector width, possibly 0. The
+// remaining samples are left for the scalar code.
+
+// s15_to_audio_sample_t().
+int AudioFormatSimdFromS15(const int16_t *pIn, audio_sample_t *pOut, int numSamples);
+
+// audio_sample_t_to_s15_clip(). If accumulate is true, the output is added to
+// pOut, wrapping around like the scalar code. The number of samples clipped
+// is added to *pClipped.
+int AudioFormatSimdToS15(const audio_sample_t *pIn, int16_t *pOut, int numSamples,
+	bool accumulate, uint32_t *pClipped);
+
+// s31_to_audio_sample_t().
+int AudioFormatSimdFromS31(const int32_t *pIn, audio_sample_t *pOut, int numSamples);
+
+// audio_sample_t_to_s31_clip(), with accumulate as for AudioFormatSimdToS15().
+int AudioFormatSimdToS31(const audio_sample_t *pIn, int32_t *pOut, int numSamples,
+	bool accumulate);
+
+// Adds pIn to pBus, wrapping around.
+int AudioFormatSimdAccumulate(const audio_sample_t *pIn, audio_sample_t *pBus, int numSamples);
+
+#endif // ANDROID_AUDIO_FORMAT_SIMD_H
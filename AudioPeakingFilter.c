@@ -21,6 +21,7 @@
 
 ///#include <new>
 #include <assert.h>
+#include <string.h>
 ///#include <cutils/compiler.h>
 
 // Format of the coefficient table:
@@ -33,14 +34,18 @@
 //        2: b2
 //        3: -a1
 //        4: -a2
-static const size_t kInDims[3] = {9, 15, 4};
 static const audio_coef_t kCoefTable[9*15*4*5] = {
 #include "AudioPeakingFilterCoef.inl"
 };
+// The interpolator of kCoefTable, shared by all the filters. The offsets are
+// the cumulative product of the dimensions, in reverse (see
+// _AudioCoefInterpolator()).
+static const AudioCoefInterpolator kCoefInterp = {
+    3, {9, 15, 4}, {15*4*5, 4*5, 5}, 5, kCoefTable
+};
 
 void _AudioPeakingFilter(AudioPeakingFilter *mpPeakingFilter, int nChannels, int sampleRate) {
     _AudioBiquadFilter(&(mpPeakingFilter->mBiquad), nChannels, sampleRate);
-	_AudioCoefInterpolator(&(mpPeakingFilter->mCoefInterp) , 3, kInDims, 5, (const audio_coef_t*) kCoefTable);
 	AudioPeakingConfigure(mpPeakingFilter, nChannels, sampleRate);///
 	AudioPeakingReset(mpPeakingFilter); 
 }
@@ -70,6 +75,12 @@ void AudioPeakingProcess(AudioPeakingFilter *mpPeakingFilter,
 	AudioBiquadProcess(&(mpPeakingFilter->mBiquad), in, out, frameCount, indx);
 }
 
+void AudioPeakingProcessFloat(AudioPeakingFilter *mpPeakingFilter,
+	const audio_sample_float_t in[], audio_sample_float_t out[], int frameCount, effect_sound_track indx) {
+
+	AudioBiquadProcessFloat(&(mpPeakingFilter->mBiquad), in, out, frameCount, indx);
+}
+
 void AudioPeakingEnable(AudioPeakingFilter *mpPeakingFilter, bool immediate) { 
 	AudioBiquadEnable(&(mpPeakingFilter->mBiquad), immediate);
 }
@@ -111,6 +122,11 @@ void AudioPeakingSetBandwidth(AudioPeakingFilter *mpPeakingFilter, uint32_t cent
 
 void AudioPeakingCommit(AudioPeakingFilter *mpPeakingFilter, bool immediate) {
     audio_coef_t coefs[5];
+	AudioPeakingGetCoefs(mpPeakingFilter, coefs);
+	AudioBiquadSetCoefs(&(mpPeakingFilter->mBiquad), coefs, immediate);
+}
+
+void AudioPeakingGetCoefs(AudioPeakingFilter *mpPeakingFilter, audio_coef_t coefs[NUM_COEFS]) {
     int intCoord[3] = {
         mpPeakingFilter->mFrequency >> FREQ_PRECISION_BITS,
         mpPeakingFilter->mGain >> GAIN_PRECISION_BITS,
@@ -121,8 +137,13 @@ void AudioPeakingCommit(AudioPeakingFilter *mpPeakingFilter, bool immediate) {
         (uint32_t)(mpPeakingFilter->mGain) << (32 - GAIN_PRECISION_BITS),
         mpPeakingFilter->mBandwidth << (32 - BANDWIDTH_PRECISION_BITS)
     };
-	AudioCoefInterpolator_GetCoef(&(mpPeakingFilter->mCoefInterp), intCoord, fracCoord, coefs);
-	AudioBiquadSetCoefs(&(mpPeakingFilter->mBiquad), coefs, immediate);
+    // At 0 mB the filter is flat, which the interpolated table only comes
+    // close to.
+    if (AudioPeakingGetGain(mpPeakingFilter) == 0) {
+        memcpy(coefs, IDENTITY_COEFS, sizeof(IDENTITY_COEFS));
+        return;
+    }
+	AudioCoefInterpolator_GetCoef(&kCoefInterp, intCoord, fracCoord, coefs);
 }
 
 void AudioPeakingGetBandRange(AudioPeakingFilter *mpPeakingFilter, uint32_t *pLow, uint32_t *pHigh) {
@@ -65,11 +65,10 @@ typedef struct _AudioPeakingFilter_ {
     // Used for scaling the frequency.
     uint32_t mFrequencyFactor;
 
-    // A biquad filter, used for the actual processing.
+    // A biquad filter, used for the actual processing. The coefficients are
+    // mapped from the high level parameters by an interpolator of the
+    // coefficient table, shared by all the filters.
     AudioBiquadFilter mBiquad;
-    // A coefficient interpolator, used for mapping the high level parameters to
-    // the low-level biquad coefficients.
-    AudioCoefInterpolator mCoefInterp;
 }AudioPeakingFilter;
 
 void AudioPeakingConfigure(AudioPeakingFilter *mpPeakingFilter, int nChannels, int sampleRate);
@@ -79,6 +78,9 @@ void AudioPeakingReset(AudioPeakingFilter *mpPeakingFilter);
 void AudioPeakingProcess(AudioPeakingFilter *mpPeakingFilter, 
 	const audio_sample_t in[], audio_sample_t out[], int frameCount, effect_sound_track indx); 
 
+void AudioPeakingProcessFloat(AudioPeakingFilter *mpPeakingFilter,
+	const audio_sample_float_t in[], audio_sample_float_t out[], int frameCount, effect_sound_track indx);
+
 void AudioPeakingEnable(AudioPeakingFilter *mpPeakingFilter, bool immediate);
 
 void AudioPeakingDisable(AudioPeakingFilter *mpPeakingFilter, bool immediate);
@@ -95,6 +97,10 @@ void AudioPeakingSetBandwidth(AudioPeakingFilter *mpPeakingFilter, uint32_t cent
 
 void AudioPeakingCommit(AudioPeakingFilter *mpPeakingFilter, bool immediate);
 
+// Computes the biquad coefficients for the current parameters, which is the
+// part of AudioPeakingCommit() that does not touch the biquad.
+void AudioPeakingGetCoefs(AudioPeakingFilter *mpPeakingFilter, audio_coef_t coefs[NUM_COEFS]);
+
 void AudioPeakingGetBandRange(AudioPeakingFilter *mpPeakingFilter, uint32_t *pLow, uint32_t *pHigh);
 
 #endif // ANDROID_AUDIO_PEAKING_FILTER_H
@@ -21,6 +21,7 @@
 
 ///#include <new>
 #include <assert.h>
+#include <string.h>
 ///#include <cutils/compiler.h>
 
 // Format of the coefficient tables:
@@ -33,24 +34,25 @@
 //        2: b2
 //        3: -a1
 //        4: -a2
-static const size_t kHiInDims[2] = {3, 15};
 static const audio_coef_t kHiCoefTable[3*15*5] = {
 #include "AudioHighShelfFilterCoef.inl"
 };
-static const size_t kLoInDims[2] = {5, 15};
 static const audio_coef_t kLoCoefTable[5*15*5] = {
 #include "AudioLowShelfFilterCoef.inl"
 };
+// The interpolators of the tables, shared by all the filters. The offsets are
+// the cumulative product of the dimensions, in reverse (see
+// _AudioCoefInterpolator()).
+static const AudioCoefInterpolator kHiCoefInterp = {
+    2, {3, 15}, {15*5, 5}, 5, kHiCoefTable
+};
+static const AudioCoefInterpolator kLoCoefInterp = {
+    2, {5, 15}, {15*5, 5}, 5, kLoCoefTable
+};
 
 void _AudioShelvingFilter(AudioShelvingFilter *mpShelf, ShelfType type, int nChannels, int sampleRate) {
     mpShelf->mType = type;      
     _AudioBiquadFilter(&(mpShelf->mBiquad), nChannels, sampleRate);
-	if(type == kLowShelf){
-	    _AudioCoefInterpolator(&(mpShelf->mLoCoefInterp), 2, kLoInDims, 5, (const audio_coef_t*)kLoCoefTable);
-	}
-	else{
-		_AudioCoefInterpolator(&(mpShelf->mHiCoefInterp), 2, kHiInDims, 5, (const audio_coef_t*)kHiCoefTable);
-	}
 	AudioShelvingConfigure(mpShelf, nChannels, sampleRate);///
 }
 
@@ -79,6 +81,12 @@ void AudioShelvingProcess(AudioShelvingFilter *mpShelf,
 	AudioBiquadProcess(&(mpShelf->mBiquad), in, out, frameCount, indx);
 }
 
+void AudioShelvingProcessFloat(AudioShelvingFilter *mpShelf,
+	const audio_sample_float_t in[], audio_sample_float_t out[], int frameCount, effect_sound_track indx) {
+
+	AudioBiquadProcessFloat(&(mpShelf->mBiquad), in, out, frameCount, indx);
+}
+
 void AudioShelvingEnable(AudioShelvingFilter *mpShelf, bool immediate) { 
 	AudioBiquadEnable(&(mpShelf->mBiquad), immediate);
 }
@@ -117,6 +125,11 @@ int32_t AudioShelvingGetGain(AudioShelvingFilter *mpShelf) {
 
 void AudioShelvingCommit(AudioShelvingFilter *mpShelf, bool immediate) {
     audio_coef_t coefs[5];
+	AudioShelvingGetCoefs(mpShelf, coefs);
+	AudioBiquadSetCoefs(&(mpShelf->mBiquad), coefs, immediate);
+}
+
+void AudioShelvingGetCoefs(AudioShelvingFilter *mpShelf, audio_coef_t coefs[NUM_COEFS]) {
     int intCoord[2] = {
         mpShelf->mFrequency >> FREQ_PRECISION_BITS,///right shift 26
         mpShelf->mGain >> GAIN_PRECISION_BITS ///right shift 10
@@ -125,11 +138,16 @@ void AudioShelvingCommit(AudioShelvingFilter *mpShelf, bool immediate) {
         mpShelf->mFrequency << (32 - FREQ_PRECISION_BITS), ///left shift 6
         (uint32_t)(mpShelf->mGain) << (32 - GAIN_PRECISION_BITS) ///left shift 22
     };
+    // At 0 mB the filter is flat, which the interpolated table only comes
+    // within 0.74 dB of.
+    if (AudioShelvingGetGain(mpShelf) == 0) {
+        memcpy(coefs, IDENTITY_COEFS, sizeof(IDENTITY_COEFS));
+        return;
+    }
     if (mpShelf->mType == kHighShelf) {
-        AudioCoefInterpolator_GetCoef(&(mpShelf->mHiCoefInterp), intCoord, fracCoord, coefs);
+        AudioCoefInterpolator_GetCoef(&kHiCoefInterp, intCoord, fracCoord, coefs);
     } else {
-        AudioCoefInterpolator_GetCoef(&(mpShelf->mLoCoefInterp), intCoord, fracCoord, coefs);
+        AudioCoefInterpolator_GetCoef(&kLoCoefInterp, intCoord, fracCoord, coefs);
     }
-	AudioBiquadSetCoefs(&(mpShelf->mBiquad), coefs, immediate);
 }
 
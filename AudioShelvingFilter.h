@@ -64,14 +64,10 @@ typedef struct _AudioShelvingFilter_ {
     // Used for scaling the frequency.
     uint32_t mFrequencyFactor;
 
-    // A biquad filter, used for the actual processing.
+    // A biquad filter, used for the actual processing. The coefficients are
+    // mapped from the high level parameters by an interpolator of the
+    // coefficient table of the shelf type, shared by all the filters.
     AudioBiquadFilter mBiquad;
-    // A coefficient interpolator, used for mapping the high level parameters to
-    // the low-level biquad coefficients. This one is used for the high shelf.
-    AudioCoefInterpolator mHiCoefInterp;
-    // A coefficient interpolator, used for mapping the high level parameters to
-    // the low-level biquad coefficients. This one is used for the low shelf.
-    AudioCoefInterpolator mLoCoefInterp;
 }AudioShelvingFilter;
 
 void AudioShelvingConfigure(AudioShelvingFilter *mpShelf, int nChannels, int sampleRate);
@@ -83,6 +79,9 @@ void AudioShelvingReset(AudioShelvingFilter *mpShelf);
 void AudioShelvingProcess(AudioShelvingFilter *mpShelf, 
 	const audio_sample_t in[], audio_sample_t out[], int frameCount, effect_sound_track indx);
 
+void AudioShelvingProcessFloat(AudioShelvingFilter *mpShelf,
+	const audio_sample_float_t in[], audio_sample_float_t out[], int frameCount, effect_sound_track indx);
+
 void AudioShelvingEnable(AudioShelvingFilter *mpShelf, bool immediate);
 
 void AudioShelvingDisable(AudioShelvingFilter *mpShelf, bool immediate);
@@ -97,5 +96,9 @@ int32_t AudioShelvingGetGain(AudioShelvingFilter *mpShelf);
 
 void AudioShelvingCommit(AudioShelvingFilter *mpShelf, bool immediate);
 
+// Computes the biquad coefficients for the current parameters, which is the
+// part of AudioShelvingCommit() that does not touch the biquad.
+void AudioShelvingGetCoefs(AudioShelvingFilter *mpShelf, audio_coef_t coefs[NUM_COEFS]);
+
 
 #endif // AUDIO_SHELVING_FILTER_H
@@ -0,0 +1,58 @@
+/*
+**
+** Copyright 2009, The Android Open Source Project
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#include "AudioSimd.h"
+
+bool AudioSimdHasSse2(void) {
+#ifdef AUDIO_SIMD_X86
+    return __builtin_cpu_supports("sse2");
+#else
+    return false;
+#endif
+}
+
+bool AudioSimdHasSse41(void) {
+#ifdef AUDIO_SIMD_X86
+    return __builtin_cpu_supports("sse4.1");
+#else
+    return false;
+#endif
+}
+
+bool AudioSimdHasAvx2(void) {
+#ifdef AUDIO_SIMD_X86
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+bool AudioSimdHasAvx512f(void) {
+#ifdef AUDIO_SIMD_X86
+    return __builtin_cpu_supports("avx512f");
+#else
+    return false;
+#endif
+}
+
+bool AudioSimdHasFma(void) {
+#ifdef AUDIO_SIMD_X86
+    return __builtin_cpu_supports("fma");
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,48 @@
+/*
+**
+** Copyright 2009, The Android Open Source Project
+**
+** Licensed under the Apache License, Version 2.0 (the "License");
+** you may not use this file except in compliance with the License.
+** You may obtain a copy of the License at
+**
+**     http://www.apache.org/licenses/LICENSE-2.0
+**
+** Unless required by applicable law or agreed to in writing, software
+** distributed under the License is distributed on an "AS IS" BASIS,
+** WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+** See the License for the specific language governing permissions and
+** limitations under the License.
+*/
+
+#ifndef ANDROID_AUDIO_SIMD_H
+#define ANDROID_AUDIO_SIMD_H
+
+#include "AudioCommon.h"
+
+// Support for the vectorized kernels.
+// The kernels are compiled for a specific instruction set using function
+// target attributes, so the rest of the code does not need any special
+// compiler flags, and are selected at runtime according to what the CPU
+// supports. Building with AUDIO_NO_SIMD defined leaves only the portable
+// C implementations, which are the reference for the vectorized ones.
+
+#if !defined(AUDIO_NO_SIMD) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AUDIO_SIMD_X86  (1)
+#include <immintrin.h>
+#define AUDIO_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+// CPU features, for selecting a kernel. All return false when the vectorized
+// kernels are not compiled in.
+bool AudioSimdHasSse2(void);
+
+bool AudioSimdHasSse41(void);
+
+bool AudioSimdHasAvx2(void);
+
+bool AudioSimdHasAvx512f(void);
+
+bool AudioSimdHasFma(void);
+
+#endif // ANDROID_AUDIO_SIMD_H
@@ -15,8 +15,10 @@
  */
 
 #include <assert.h>
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include "AudioEqualizer.h"
 #include "AudioBiquadFilter.h"
 #include "AudioFormatAdapter.h"
@@ -33,7 +35,7 @@ const effect_descriptor_t gEqualizerDescriptor = {
         {0x0bed4300, 0xddd6, 0x11db, 0x8f34, {0x00, 0x02, 0xa5, 0xd5, 0xc5, 0x1b}}, // type
         {0xe25aa840, 0x543b, 0x11df, 0x98a5, {0x00, 0x02, 0xa5, 0xd5, 0xc5, 0x1b}}, // uuid
         EFFECT_CONTROL_API_VERSION,
-        (EFFECT_FLAG_TYPE_INSERT | EFFECT_FLAG_INSERT_LAST),
+        (EFFECT_FLAG_TYPE_INSERT | EFFECT_FLAG_INSERT_LAST | EFFECT_FLAG_VOLUME_CTRL),
         0, // TODO
         1,
         "Graphic Equalizer",
@@ -113,11 +115,66 @@ typedef struct _EqualizerContext_ {
     AudioFormatAdapter *pAdapter;
     AUDIO_EQUALIZER * pEqualizer;
     uint32_t state;
+    // Whether parameters were set by EFFECT_CMD_SET_PARAM_DEFERRED since the
+    // last commit.
+    bool deferred;
+    // Number of bands, kNumBands unless set through EQ_PARAM_NUM_BANDS.
+    int32_t numBands;
+    // First of the numBands - 2 peaking filters of the instance, in
+    // gPeakingFilters.
+    int32_t firstPeaking;
+    // Counters of the audio thread, for EQ_CMD_GET_STATS. The commits are
+    // counted by the equalizer (see AudioEqualizerGetNumPublished()).
+    equalizer_stats_t stats;
 }EqualizerContext;
 
-EqualizerContext gContext;
-AUDIO_EQUALIZER gEqualizer;
-AudioFormatAdapter gAdapter;
+// Instances are allocated from a static pool, so EffectCreate() never calls
+// the heap allocator. Each entry holds all the state of one effect instance;
+// its context is the handle. The entries are handed out in order up to the
+// high-water mark, then from the list of released ones.
+// Like the rest of the effect library interface, EffectCreate() and
+// EffectRelease() are serialized by the caller (the effect factory).
+#ifndef EQUALIZER_MAX_INSTANCES
+// Max number of concurrent instances. An entry takes about 19 KB, and an
+// instance of kNumBands bands about 1.7 KB of the arena of peaking filters
+// below, so the default reserves about 21 MB; the pages of the entries never
+// handed out are never touched. Define it for more or fewer instances.
+#define EQUALIZER_MAX_INSTANCES  (1024)
+#endif
+
+#ifndef EQUALIZER_MAX_PEAKING
+// Number of peaking filters shared by all the instances: enough for every
+// instance to have kNumBands bands. An instance with more bands takes the
+// room of others. Define it for instances with more bands.
+#define EQUALIZER_MAX_PEAKING  (EQUALIZER_MAX_INSTANCES * (kNumBands - 2))
+#endif
+
+typedef struct _EqualizerInstance_ {
+    EqualizerContext context;
+    AUDIO_EQUALIZER equalizer;
+    AudioFormatAdapter adapter;
+    // Whether the entry is allocated.
+    bool inUse;
+    // Index of the next released entry, -1 for the last one.
+    int32_t nextFree;
+}EqualizerInstance;
+
+static EqualizerInstance gInstances[EQUALIZER_MAX_INSTANCES];
+// Number of entries ever handed out.
+static int32_t gNumInstances = 0;
+// First released entry, -1 if none.
+static int32_t gFirstFree = -1;
+
+// The peaking filters of the instances, which take a number of bands that
+// can change at run time, so the entries of the pool only hold the shelves.
+// Each instance has a run of numBands - 2 contiguous filters, taken first
+// fit. EQ_PARAM_NUM_BANDS resizes it from the command path, which is not
+// serialized with EffectCreate() and EffectRelease(), so the arena has a
+// lock of its own. It is never taken on the audio thread.
+static AudioPeakingFilter gPeakingFilters[EQUALIZER_MAX_PEAKING];
+// Whether each filter of gPeakingFilters belongs to an instance.
+static bool gPeakingInUse[EQUALIZER_MAX_PEAKING];
+static pthread_mutex_t gPeakingLock = PTHREAD_MUTEX_INITIALIZER;
 
 AUDIO_EQ_CONFIG gConfig;
 AUDIO_EQ_CONFIG *pEQcmd = &gConfig;
@@ -131,9 +188,101 @@ bool isSetBandWidth;
 //--- local function prototypes
 
 int Equalizer_init(EqualizerContext *pContext);
+int Equalizer_setNumBands(EqualizerContext *pContext, int32_t numBands);
+int Equalizer_setVolume(EqualizerContext *pContext, const uint32_t volumes[2], uint32_t residues[2]);
 int Equalizer_setConfig(EqualizerContext *pContext, effect_config_t *pConfig);
 int Equalizer_getParameter(AUDIO_EQUALIZER * pEqualizer, int32_t *pParam, uint32_t *pValueSize, void *pValue);
-int Equalizer_setParameter(AUDIO_EQUALIZER * pEqualizer, int32_t *pParam, void *pValue);
+int Equalizer_setParameter(AUDIO_EQUALIZER * pEqualizer, int32_t *pParam, void *pValue, bool commit);
+static void Equalizer_resetStats(EqualizerContext *pContext);
+void Equalizer_setBands(AUDIO_EQUALIZER * pEqualizer, const int32_t *pGains, const int32_t *pFreqs,
+        const int32_t *pBandwidths);
+
+//
+//--- Instance pool
+//
+
+// Returns a free entry of the pool, NULL if all are in use.
+static EqualizerInstance *Equalizer_allocInstance(void)
+{
+    EqualizerInstance *pInstance = NULL;
+
+    if (gFirstFree >= 0) {
+        pInstance = &gInstances[gFirstFree];
+        gFirstFree = pInstance->nextFree;
+    } else if (gNumInstances < EQUALIZER_MAX_INSTANCES) {
+        pInstance = &gInstances[gNumInstances++];
+    } else {
+        return NULL;
+    }
+    pInstance->inUse = true;
+    pInstance->nextFree = -1;
+    return pInstance;
+}
+
+// Returns the entry of a handle, NULL if it is not an allocated instance.
+static EqualizerInstance *Equalizer_getInstance(effect_handle_t handle)
+{
+    const char *p = (const char *) handle;
+    const char *base = (const char *) gInstances;
+    EqualizerInstance *pInstance = NULL;
+
+    if (p < base || p >= base + sizeof(gInstances)
+            || (size_t) (p - base) % sizeof(gInstances[0]) != 0) {
+        return NULL;
+    }
+    pInstance = &gInstances[(size_t) (p - base) / sizeof(gInstances[0])];
+    return pInstance->inUse ? pInstance : NULL;
+}
+
+static void Equalizer_freeInstance(EqualizerInstance *pInstance)
+{
+    pInstance->inUse = false;
+    pInstance->nextFree = gFirstFree;
+    gFirstFree = (int32_t) (pInstance - gInstances);
+}
+
+static void Equalizer_markPeaking(int32_t first, int32_t count, bool inUse)
+{
+    int32_t i;
+
+    for (i = first; i < first + count; ++i) {
+        gPeakingInUse[i] = inUse;
+    }
+}
+
+// Returns the first of count contiguous free filters of the arena, first fit,
+// -1 if there is no such run.
+static int32_t Equalizer_findPeaking(int32_t count)
+{
+    int32_t first;
+    int32_t i = 0;
+
+    for (first = 0; first + count <= EQUALIZER_MAX_PEAKING; first = i + 1) {
+        for (i = first; i < first + count && !gPeakingInUse[i]; ++i) {
+        }
+        if (i == first + count) {
+            return first;
+        }
+    }
+    return -1;
+}
+
+// Swaps the run of oldCount peaking filters at *pFirst for a run of newCount.
+// The old run is kept if there is no room for the new one.
+static int Equalizer_resizePeaking(int32_t *pFirst, int32_t oldCount, int32_t newCount)
+{
+    int32_t first;
+
+    pthread_mutex_lock(&gPeakingLock);
+    Equalizer_markPeaking(*pFirst, oldCount, false);
+    first = Equalizer_findPeaking(newCount);
+    if (first >= 0) {
+        *pFirst = first;
+    }
+    Equalizer_markPeaking(*pFirst, first >= 0 ? newCount : oldCount, true);
+    pthread_mutex_unlock(&gPeakingLock);
+    return first >= 0 ? 0 : -ENOMEM;
+}
 
 
 //
@@ -147,6 +296,7 @@ extern int EffectCreate(const effect_uuid_t *uuid,
     int ret;
     int i;
 	EqualizerContext *pContext = NULL;
+	EqualizerInstance *pInstance = NULL;
 
     if (pHandle == NULL || uuid == NULL) {
         return -EINVAL;
@@ -156,16 +306,29 @@ extern int EffectCreate(const effect_uuid_t *uuid,
         return -EINVAL;
     }
 
-    pContext = &gContext;
-	pContext->pEqualizer = &gEqualizer;
-	pContext->pAdapter = &gAdapter;
+    pInstance = Equalizer_allocInstance();
+    if (pInstance == NULL) {
+        return -ENOMEM;
+    }
+    pContext = &pInstance->context;
+	pContext->pEqualizer = &pInstance->equalizer;
+	pContext->pAdapter = &pInstance->adapter;
+	pContext->numBands = kNumBands;
+	pContext->firstPeaking = 0;
 	
     pContext->state = EQUALIZER_STATE_UNINITIALIZED;
-    ret = Equalizer_init(pContext);
+    ret = Equalizer_resizePeaking(&pContext->firstPeaking, 0, pContext->numBands - 2);
+    if (ret == 0) {
+        ret = Equalizer_init(pContext);
+        if (ret != 0) {
+            Equalizer_resizePeaking(&pContext->firstPeaking, pContext->numBands - 2, 0);
+        }
+    }
     if (ret != 0) {
 		pContext->pEqualizer = NULL;
 		pContext->pAdapter = NULL;
 		pContext = NULL;
+		Equalizer_freeInstance(pInstance);
         return ret;
     }
 
@@ -176,16 +339,20 @@ extern int EffectCreate(const effect_uuid_t *uuid,
 } /* end EffectCreate */
 
 extern int EffectRelease(effect_handle_t handle) {
-    EqualizerContext * pContext = (EqualizerContext *)handle;
+    EqualizerInstance *pInstance = Equalizer_getInstance(handle);
+    EqualizerContext * pContext = NULL;
 
-    if (pContext == NULL) {
+    if (pInstance == NULL) {
         return -EINVAL;
     }
+    pContext = &pInstance->context;
 
     pContext->state = EQUALIZER_STATE_UNINITIALIZED;
+    Equalizer_resizePeaking(&pContext->firstPeaking, pContext->numBands - 2, 0);
 	pContext->pEqualizer = NULL;
 	pContext->pAdapter = NULL;
 	pContext = NULL;
+	Equalizer_freeInstance(pInstance);
 
     return 0;
 } /* end EffectRelease */
@@ -243,8 +410,15 @@ int Equalizer_setConfig(EqualizerContext *pContext, effect_config_t *pConfig)
     CHECK_ARG((pConfig->inputCfg.channels == AUDIO_CHANNEL_OUT_MONO) ||
               (pConfig->inputCfg.channels == AUDIO_CHANNEL_OUT_STEREO));
     CHECK_ARG(pConfig->outputCfg.accessMode == EFFECT_BUFFER_ACCESS_WRITE
-              || pConfig->outputCfg.accessMode == EFFECT_BUFFER_ACCESS_ACCUMULATE);
-    CHECK_ARG(pConfig->inputCfg.format == AUDIO_FORMAT_PCM_16_BIT);
+              || pConfig->outputCfg.accessMode == EFFECT_BUFFER_ACCESS_ACCUMULATE
+              || pConfig->outputCfg.accessMode == EFFECT_BUFFER_ACCESS_ACCUMULATE_WIDE);
+    // The format selects the engine: floating point for float, fixed point
+    // for the others.
+    CHECK_ARG(pConfig->inputCfg.format == AUDIO_FORMAT_PCM_16_BIT
+              || pConfig->inputCfg.format == AUDIO_FORMAT_PCM_8_24_BIT
+              || pConfig->inputCfg.format == AUDIO_FORMAT_PCM_32_BIT
+              || pConfig->inputCfg.format == AUDIO_FORMAT_PCM_24_BIT_PACKED
+              || pConfig->inputCfg.format == AUDIO_FORMAT_PCM_FLOAT);
 
     if (pConfig->inputCfg.channels == AUDIO_CHANNEL_OUT_MONO) {
         channelCount = 1;
@@ -257,6 +431,12 @@ int Equalizer_setConfig(EqualizerContext *pContext, effect_config_t *pConfig)
 
     AudioEqualizerConfigure(pContext->pEqualizer, channelCount,
                           pConfig->inputCfg.samplingRate);
+    // Configuring commits the bands at their own coefficients, without the
+    // volume folded into the last one, so the settings go out again. A burst
+    // of deferred parameters publishes them on its commit.
+    if (!pContext->deferred) {
+        AudioEqualizerPublish(pContext->pEqualizer, true);
+    }
 
 	AudioFormatAdapterConfigure(pContext->pAdapter, pContext->pEqualizer, 
 		                channelCount,
@@ -303,8 +483,9 @@ int Equalizer_init(EqualizerContext *pContext)
 {
     int status;
 	int i = 0;
-    int32_t tmpNumBands = kNumBands;
+	bool isDefault;
     CHECK_ARG(pContext != NULL);
+    isDefault = pContext->numBands == kNumBands;
 
     pContext->config.inputCfg.accessMode = EFFECT_BUFFER_ACCESS_READ;
     pContext->config.inputCfg.channels = AUDIO_CHANNEL_OUT_MONO;///AUDIO_CHANNEL_OUT_STEREO
@@ -323,24 +504,111 @@ int Equalizer_init(EqualizerContext *pContext)
     pContext->config.outputCfg.bufferProvider.cookie = NULL;
     pContext->config.outputCfg.mask = EFFECT_CONFIG_ALL;
 	
+    // The presets and the default frequencies are those of kNumBands bands.
+    // Any other number of bands starts flat, spread evenly over the octaves,
+    // without presets.
     _AudioEqualizer(pContext->pEqualizer, 
-		tmpNumBands, 
+		pContext->numBands, 
 		1, 
 		44100, 
-		gEqualizerPresets, 
-		ARRAY_SIZE(gEqualizerPresets));
+		isDefault ? gEqualizerPresets : NULL, 
+		isDefault ? ARRAY_SIZE(gEqualizerPresets) : 0,
+		&gPeakingFilters[pContext->firstPeaking]);
 
-	for (i = 0; i < kNumBands; ++i) {
+	for (i = 0; isDefault && i < kNumBands; ++i) {
         AudioEqualizerSetGain(pContext->pEqualizer, i, 0x00);
         AudioEqualizerSetFrequency(pContext->pEqualizer, i, gFreqs[i]);
         AudioEqualizerSetBandwidth(pContext->pEqualizer, i, gBandwidths[i]);
     }
     AudioEqualizerEnable(pContext->pEqualizer, true);
+    pContext->deferred = false;
+    Equalizer_resetStats(pContext);
     Equalizer_setConfig(pContext, &pContext->config);
 
     return 0;
 }   // end Equalizer_init
 
+//----------------------------------------------------------------------------
+// Equalizer_setNumBands()
+//----------------------------------------------------------------------------
+// Purpose: Change the number of bands of the equalizer, which rebuilds it
+//          from scratch (see Equalizer_init()), keeping the configuration.
+//          The effect must not be enabled, as the bands would be reshaped
+//          under the audio thread. Fails with -ENOMEM, leaving the equalizer
+//          as it is, when there is no room for the bands in the arena.
+//
+// Inputs:
+//  pContext:   effect engine context
+//  numBands:   number of bands, from 2 (the shelves) to MAX_EQ_BANDS
+//
+// Outputs:
+//
+//----------------------------------------------------------------------------
+
+int Equalizer_setNumBands(EqualizerContext *pContext, int32_t numBands)
+{
+    effect_config_t config;
+    int ret;
+
+    if (numBands < 2 || numBands > MAX_EQ_BANDS) {
+        return -EINVAL;
+    }
+    if (pContext->state == EQUALIZER_STATE_ACTIVE) {
+        return -ENOSYS;
+    }
+    ret = Equalizer_resizePeaking(&pContext->firstPeaking, pContext->numBands - 2, numBands - 2);
+    if (ret != 0) {
+        return ret;
+    }
+    config = pContext->config;
+    pContext->numBands = numBands;
+    Equalizer_init(pContext);
+    return Equalizer_setConfig(pContext, &config);
+}   // end Equalizer_setNumBands
+
+//----------------------------------------------------------------------------
+// Equalizer_setVolume()
+//----------------------------------------------------------------------------
+// Purpose: Apply the volume of EFFECT_CMD_SET_VOLUME, as the gain of the EQ
+//          (see AudioEqualizerSetVolume()), which ramps to it. The channels
+//          share the coefficients, so only the volume common to them, up to
+//          unity, is applied here; the host is left with the rest.
+//
+// Inputs:
+//  pContext:   effect engine context
+//  volumes:    left and right volumes, in 8.24 fixed point
+//
+// Outputs:
+//  residues:   left and right volumes left for the host to apply, in 8.24
+//              fixed point. If NULL, the host applies none, and the volumes
+//              must be equal and at most unity.
+//
+//----------------------------------------------------------------------------
+
+int Equalizer_setVolume(EqualizerContext *pContext, const uint32_t volumes[2], uint32_t residues[2])
+{
+    uint32_t volume = volumes[0] > volumes[1] ? volumes[0] : volumes[1];
+    int ch;
+
+    if (volume > AUDIO_COEF_ONE) {
+        volume = AUDIO_COEF_ONE;
+    }
+    if (residues == NULL && (volumes[0] != volume || volumes[1] != volume)) {
+        return -EINVAL;
+    }
+    for (ch = 0; residues != NULL && ch < 2; ++ch) {
+        residues[ch] = volume == 0 ? AUDIO_COEF_ONE
+                : (uint32_t) ((((uint64_t) volumes[ch]) << AUDIO_COEF_PRECISION) / volume);
+    }
+    AudioEqualizerSetVolume(pContext->pEqualizer, (audio_coef_t) volume);
+    // Parameters staged by EFFECT_CMD_SET_PARAM_DEFERRED would go along, so
+    // the volume waits for their commit instead.
+    if (!pContext->deferred) {
+        AudioEqualizerPublish(pContext->pEqualizer, false);
+    }
+    return 0;
+}   // end Equalizer_setVolume
+
 
 //----------------------------------------------------------------------------
 // Equalizer_getParameter()
@@ -367,6 +635,7 @@ int Equalizer_getParameter(AUDIO_EQUALIZER * pEqualizer, int32_t *pParam, uint32
 {
     int status = 0;
 	int i = 0;
+    const int32_t numBands = AudioEqualizerGetNumBands(pEqualizer);
     int32_t param = *pParam++;
     int32_t param2;
     char *name;
@@ -408,10 +677,10 @@ int Equalizer_getParameter(AUDIO_EQUALIZER * pEqualizer, int32_t *pParam, uint32
         break;
 
     case EQ_PARAM_PROPERTIES:
-        if (*pValueSize < (2 + kNumBands) * sizeof(uint16_t)) {
+        if (*pValueSize < (2 + numBands) * sizeof(uint16_t)) {
             return -EINVAL;
         }
-        *pValueSize = (2 + kNumBands) * sizeof(uint16_t);
+        *pValueSize = (2 + numBands) * sizeof(uint16_t);
         break;
 
     default:
@@ -420,7 +689,7 @@ int Equalizer_getParameter(AUDIO_EQUALIZER * pEqualizer, int32_t *pParam, uint32
 
     switch (param) {
     case EQ_PARAM_NUM_BANDS:
-        *(uint16_t *)pValue = (uint16_t)kNumBands;
+        *(uint16_t *)pValue = (uint16_t)numBands;
         break;
 
     case EQ_PARAM_LEVEL_RANGE:
@@ -430,7 +699,7 @@ int Equalizer_getParameter(AUDIO_EQUALIZER * pEqualizer, int32_t *pParam, uint32
 
     case EQ_PARAM_BAND_LEVEL:
         param2 = *pParam;
-        if (param2 >= kNumBands) {
+        if (param2 >= numBands) {
             status = -EINVAL;
             break;
         }
@@ -439,7 +708,7 @@ int Equalizer_getParameter(AUDIO_EQUALIZER * pEqualizer, int32_t *pParam, uint32
 
     case EQ_PARAM_CENTER_FREQ:
         param2 = *pParam;
-        if (param2 >= kNumBands) {
+        if (param2 >= numBands) {
             status = -EINVAL;
             break;
         }
@@ -448,7 +717,7 @@ int Equalizer_getParameter(AUDIO_EQUALIZER * pEqualizer, int32_t *pParam, uint32
 
     case EQ_PARAM_BAND_FREQ_RANGE:
         param2 = *pParam;
-        if (param2 >= kNumBands) {
+        if (param2 >= numBands) {
             status = -EINVAL;
             break;
         }
@@ -483,8 +752,8 @@ int Equalizer_getParameter(AUDIO_EQUALIZER * pEqualizer, int32_t *pParam, uint32
     case EQ_PARAM_PROPERTIES: {
         int16_t *p = (int16_t *)pValue;
         p[0] = (int16_t)AudioEqualizerGetPreset(pEqualizer);
-        p[1] = (int16_t)kNumBands;
-        for (i = 0; i < kNumBands; i++) {
+        p[1] = (int16_t)numBands;
+        for (i = 0; i < numBands; i++) {
             p[2 + i] = (int16_t)AudioEqualizerGetGain(pEqualizer, i);
         }
     } break;
@@ -508,22 +777,27 @@ int Equalizer_getParameter(AUDIO_EQUALIZER * pEqualizer, int32_t *pParam, uint32
 //  pEqualizer       - handle to instance data
 //  pParam           - pointer to parameter
 //  pValue           - pointer to value
+//  commit           - whether to commit the parameters now, or leave them
+//                     staged for a later commit
 //
 // Outputs:
 //
 //
 // Side Effects:
+//  A commit publishes the settings of all the parameters set so far to the
+//  audio thread, which applies them before its next block (see
+//  AudioEqualizerPublish()).
 //
 //----------------------------------------------------------------------------
 
-int Equalizer_setParameter (AUDIO_EQUALIZER * pEqualizer, int32_t *pParam, void *pValue)
+int Equalizer_setParameter (AUDIO_EQUALIZER * pEqualizer, int32_t *pParam, void *pValue, bool commit)
 {
-	int i = 0;
     int status = 0;
     int32_t preset;
     int32_t band;
     int32_t level;
     int32_t param = *pParam++;
+    const int32_t numBands = AudioEqualizerGetNumBands(pEqualizer);
     
 	switch (param) {
     case EQ_PARAM_CUR_PRESET:
@@ -534,17 +808,15 @@ int Equalizer_setParameter (AUDIO_EQUALIZER * pEqualizer, int32_t *pParam, void
             break;
         }
 		AudioEqualizerSetPreset(pEqualizer, preset);
-		AudioEqualizerCommit(pEqualizer, true);
         break;
     case EQ_PARAM_BAND_LEVEL:
         band =  *pParam;
         level = *(int32_t *)pValue;
-        if (band >= kNumBands) {
+        if (band >= numBands) {
             status = -EINVAL;
             break;
         }
 		AudioEqualizerSetGain(pEqualizer, band, level);
-		AudioEqualizerCommit(pEqualizer, true);
         break;
     case EQ_PARAM_PROPERTIES: {
         int32_t *p = (int32_t *)pValue;
@@ -555,52 +827,277 @@ int Equalizer_setParameter (AUDIO_EQUALIZER * pEqualizer, int32_t *pParam, void
         if (p[0] >= 1) {///changed by wangwp, 0 stand for customer mode
 			AudioEqualizerSetPreset(pEqualizer, p[0]);
         } else {
-            if ((int)p[1] != kNumBands) {
+            // Gains, frequencies and bandwidths follow, numBands each.
+            if ((int)p[1] != numBands) {
                 status = -EINVAL;
                 break;
             }
-			if(isSetGain) {
-                for (i = 0; i < kNumBands; i++) {
-				    AudioEqualizerSetGain(pEqualizer, i, p[2 + i]);
-                }				
-			}			
-			if(isSetFreq) {
-                for (i = 0; i < kNumBands; i++) {
-				    AudioEqualizerSetFrequency(pEqualizer, i, p[7 + i]);
-                }
-			}
-			if(isSetBandWidth) {
-                for (i = 0; i < kNumBands; i++) {
-				    AudioEqualizerSetBandwidth(pEqualizer, i, p[12 + i]);
-                }
-			}
-        }
-        AudioEqualizerCommit(pEqualizer, true);
+            Equalizer_setBands(pEqualizer,
+                    isSetGain ? p + 2 : NULL,
+                    isSetFreq ? p + 2 + numBands : NULL,
+                    isSetBandWidth ? p + 2 + 2 * numBands : NULL);
+        }
     } break;
     default:
         status = -EINVAL;
         break;
     }
 
+    if (status == 0 && commit) {
+        AudioEqualizerPublish(pEqualizer, true);
+    }
     return status;
 } // end Equalizer_setParameter
 
+//----------------------------------------------------------------------------
+// Equalizer_setBands()
+//----------------------------------------------------------------------------
+// Purpose:
+// Set the gains, center frequencies and bandwidths of all the bands, without
+// committing them
+//
+// Inputs:
+//  pEqualizer       - handle to instance data
+//  pGains           - gain of each band, in millibels, or NULL to keep them
+//  pFreqs           - center frequency of each band, in millihertz, or NULL
+//  pBandwidths      - bandwidth of each band, in cents, or NULL. Only the
+//                     peaking bands have one
+//
+// Outputs:
+//
+//----------------------------------------------------------------------------
+
+void Equalizer_setBands(AUDIO_EQUALIZER * pEqualizer, const int32_t *pGains, const int32_t *pFreqs,
+        const int32_t *pBandwidths)
+{
+    int i = 0;
+    const int32_t numBands = AudioEqualizerGetNumBands(pEqualizer);
+
+    for (i = 0; pGains != NULL && i < numBands; i++) {
+        AudioEqualizerSetGain(pEqualizer, i, pGains[i]);
+    }
+    for (i = 0; pFreqs != NULL && i < numBands; i++) {
+        AudioEqualizerSetFrequency(pEqualizer, i, pFreqs[i]);
+    }
+    for (i = 0; pBandwidths != NULL && i < numBands; i++) {
+        AudioEqualizerSetBandwidth(pEqualizer, i, pBandwidths[i]);
+    }
+} // end Equalizer_setBands
+
 //
 //--- Effect Control Interface Implementation
 //
 
+// Returns true if an input and an output buffer of frameCount frames overlap
+// without being the same buffer, which would be overwritten before being
+// read. The same buffer is processed in place.
+static bool Equalizer_buffersOverlap(EqualizerContext *pContext, const void *in, const void *out,
+        size_t frameCount)
+{
+    const char *pIn = (const char *) in;
+    const char *pOut = (const char *) out;
+    const size_t inSize = frameCount * AudioFormatAdapterGetFrameSize(pContext->pAdapter, false);
+    const size_t outSize = frameCount * AudioFormatAdapterGetFrameSize(pContext->pAdapter, true);
+
+    if (pIn == pOut) {
+        return inSize != outSize;
+    }
+    return pIn < pOut + outSize && pOut < pIn + inSize;
+}
+
+// One side of a block: the buffer passed to process(), or in pull mode, the
+// buffers handed out by the provider of the configuration, one at a time.
+typedef struct _EqualizerStream_ {
+    // The provider, NULL for a buffer passed to process().
+    const buffer_provider_t *pProvider;
+    // The current buffer, no buffer (raw is NULL) while a provider holds none.
+    audio_buffer_t buffer;
+    // Size of a frame, in bytes.
+    size_t frameSize;
+    // Number of frames of the current buffer already processed.
+    size_t used;
+}EqualizerStream;
+
+// Sets up one side of a block. If pBuffer is NULL, the buffers are pulled from
+// the provider of pConfig, which must have been configured.
+static int Equalizer_openStream(EqualizerStream *pStream, audio_buffer_t *pBuffer,
+        const buffer_config_t *pConfig, size_t frameSize)
+{
+    pStream->frameSize = frameSize;
+    pStream->used = 0;
+    if (pBuffer != NULL) {
+        if (pBuffer->raw == NULL) {
+            return -EINVAL;
+        }
+        pStream->pProvider = NULL;
+        pStream->buffer = *pBuffer;
+        return 0;
+    }
+    if (!(pConfig->mask & EFFECT_CONFIG_PROVIDER) || pConfig->bufferProvider.getBuffer == NULL
+            || pConfig->bufferProvider.releaseBuffer == NULL) {
+        return -EINVAL;
+    }
+    pStream->pProvider = &pConfig->bufferProvider;
+    pStream->buffer.raw = NULL;
+    pStream->buffer.frameCount = 0;
+    return 0;
+}
+
+// Returns the number of frames left in the current buffer. In pull mode, gets
+// a buffer of up to frameCount frames from the provider first if none is held;
+// 0 means the provider has none to give.
+static size_t Equalizer_streamAvail(EqualizerStream *pStream, size_t frameCount)
+{
+    if (pStream->pProvider != NULL && pStream->buffer.raw == NULL) {
+        pStream->buffer.frameCount = frameCount;
+        pStream->used = 0;
+        if (pStream->pProvider->getBuffer(pStream->pProvider->cookie, &pStream->buffer) != 0
+                || pStream->buffer.raw == NULL) {
+            pStream->buffer.raw = NULL;
+            pStream->buffer.frameCount = 0;
+        }
+    }
+    return pStream->buffer.frameCount - pStream->used;
+}
+
+// Hands the current buffer back to the provider, with the number of frames
+// processed, in pull mode. Does nothing for a buffer passed to process().
+static void Equalizer_streamRelease(EqualizerStream *pStream)
+{
+    if (pStream->pProvider != NULL && pStream->buffer.raw != NULL) {
+        pStream->buffer.frameCount = pStream->used;
+        pStream->pProvider->releaseBuffer(pStream->pProvider->cookie, &pStream->buffer);
+        pStream->buffer.raw = NULL;
+        pStream->buffer.frameCount = 0;
+    }
+}
+
+// The counters of equalizer_stats_t are updated by the audio thread, once per
+// block, and read by the control thread at any time. Relaxed atomic stores
+// and loads are enough: each counter is read whole, and they need no ordering
+// between them. Timing reads the monotonic clock twice per block.
+
+// A block being processed, for the statistics.
+typedef struct _EqualizerBlock_ {
+    // When the block started, in nanoseconds.
+    uint64_t start;
+    // Whether the block picked up new settings.
+    bool fetched;
+    // Whether the block started in a coefficient transition.
+    bool transition;
+    // Number of bands bypassed.
+    int bypassed;
+}EqualizerBlock;
+
+static uint64_t Equalizer_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+// Adds n to a counter of the audio thread.
+static void Equalizer_count(uint64_t *pCounter, uint64_t n)
+{
+    __atomic_store_n(pCounter, *pCounter + n, __ATOMIC_RELAXED);
+}
+
+// Starts a block: applies the settings published by the control thread
+// since the last one, and takes note of the state of the bands.
+static void Equalizer_beginBlock(EqualizerContext *pContext, EqualizerBlock *pBlock)
+{
+    pBlock->start = Equalizer_now();
+    pBlock->fetched = AudioEqualizerFetch(pContext->pEqualizer);
+    pBlock->transition = !AudioEqualizerIsSteady(pContext->pEqualizer);
+    pBlock->bypassed = AudioEqualizerGetNumBypassed(pContext->pEqualizer);
+}
+
+// Ends a block of frameCount frames, of all the tracks, and counts it.
+static void Equalizer_endBlock(EqualizerContext *pContext, EqualizerBlock *pBlock, size_t frameCount)
+{
+    equalizer_stats_t *pStats = &pContext->stats;
+    const uint64_t ns = Equalizer_now() - pBlock->start;
+
+    Equalizer_count(&pStats->processCalls, 1);
+    Equalizer_count(&pStats->framesProcessed, frameCount);
+    Equalizer_count(&pStats->processNs, ns);
+    if (ns > pStats->maxProcessNs) {
+        __atomic_store_n(&pStats->maxProcessNs, ns, __ATOMIC_RELAXED);
+    }
+    if (pBlock->transition) {
+        Equalizer_count(&pStats->transitionCalls, 1);
+        Equalizer_count(&pStats->transitionNs, ns);
+    }
+    Equalizer_count(&pStats->sections, AudioEqualizerGetNumBands(pContext->pEqualizer));
+    Equalizer_count(&pStats->bypassedSections, pBlock->bypassed);
+    Equalizer_count(&pStats->clippedSamples, AudioFormatAdapterTakeNumClipped(pContext->pAdapter));
+    Equalizer_count(&pStats->appliedCommits, pBlock->fetched);
+}
+
+// Takes a snapshot of the statistics, from the control thread.
+static void Equalizer_getStats(EqualizerContext *pContext, equalizer_stats_t *pStats)
+{
+    const uint64_t *pCounters = (const uint64_t *) &pContext->stats;
+    uint64_t *pSnapshot = (uint64_t *) pStats;
+    size_t i;
+
+    for (i = 0; i < sizeof(equalizer_stats_t) / sizeof(uint64_t); ++i) {
+        pSnapshot[i] = __atomic_load_n(&pCounters[i], __ATOMIC_RELAXED);
+    }
+    pStats->commits = AudioEqualizerGetNumPublished(pContext->pEqualizer);
+}
+
+// Zeroes the statistics, from the control thread, with the same relaxed
+// stores as the audio thread so that a block ending meanwhile does not race.
+static void Equalizer_resetStats(EqualizerContext *pContext)
+{
+    uint64_t *pCounters = (uint64_t *) &pContext->stats;
+    size_t i;
+
+    for (i = 0; i < sizeof(equalizer_stats_t) / sizeof(uint64_t); ++i) {
+        __atomic_store_n(&pCounters[i], 0, __ATOMIC_RELAXED);
+    }
+}
+
+// Processes a block. A NULL inBuffer or outBuffer selects pull mode for that
+// side: the samples are read from, or written to, the buffers of the provider
+// set by EFFECT_CMD_SET_CONFIG (with EFFECT_CONFIG_PROVIDER in the mask), so
+// no intermediate block is needed. Each buffer is asked for with the number of
+// frames still to process, may come with fewer, and is released once used up,
+// or at the end of the block with the number of frames used. The block has
+// the size of the buffer passed in, or if both sides pull, the frameCount of
+// the output buffer of the configuration. Returns -EAGAIN if a provider ran
+// out of buffers before the end of the block; the frames before that are
+// processed.
 extern int Equalizer_process(effect_handle_t self, audio_buffer_t *inBuffer, audio_buffer_t *outBuffer, effect_sound_track indx)
 {
     EqualizerContext * pContext = (EqualizerContext *) self;
+    EqualizerStream in;
+    EqualizerStream out;
+    size_t frameCount;
+    size_t done = 0;
+    size_t n;
+    size_t avail;
+    void *pIn;
+    void *pOut;
+    int status = 0;
+    EqualizerBlock block;
 
     if (pContext == NULL) {
         return -EINVAL;
     }
-    if (inBuffer == NULL || inBuffer->s16 == NULL ||
-        outBuffer == NULL || outBuffer->s16 == NULL ||
-        inBuffer->frameCount != outBuffer->frameCount) {
+    if (Equalizer_openStream(&in, inBuffer, &pContext->config.inputCfg,
+                AudioFormatAdapterGetFrameSize(pContext->pAdapter, false)) != 0 ||
+        Equalizer_openStream(&out, outBuffer, &pContext->config.outputCfg,
+                AudioFormatAdapterGetFrameSize(pContext->pAdapter, true)) != 0) {
+        return -EINVAL;
+    }
+    if (inBuffer != NULL && outBuffer != NULL && inBuffer->frameCount != outBuffer->frameCount) {
         return -EINVAL;
     }
+    frameCount = outBuffer != NULL ? outBuffer->frameCount
+            : inBuffer != NULL ? inBuffer->frameCount : pContext->config.outputCfg.buffer.frameCount;
 
     if (pContext->state == EQUALIZER_STATE_UNINITIALIZED) {
         return -EINVAL;
@@ -610,11 +1107,130 @@ extern int Equalizer_process(effect_handle_t self, audio_buffer_t *inBuffer, aud
         ///return -61;///from errno.h
     }
 
-	AudioFormatAdapterProcess(pContext->pAdapter, inBuffer->s16, outBuffer->s16, outBuffer->frameCount, indx);
+    Equalizer_beginBlock(pContext, &block);
+    while (done < frameCount) {
+        n = frameCount - done;
+        avail = Equalizer_streamAvail(&in, n);
+        n = avail < n ? avail : n;
+        avail = n > 0 ? Equalizer_streamAvail(&out, n) : 0;
+        n = avail < n ? avail : n;
+        if (n == 0) {
+            status = -EAGAIN;
+            break;
+        }
+        pIn = (char *) in.buffer.raw + in.used * in.frameSize;
+        pOut = (char *) out.buffer.raw + out.used * out.frameSize;
+        if (Equalizer_buffersOverlap(pContext, pIn, pOut, n)) {
+            status = -EINVAL;
+            break;
+        }
+        AudioFormatAdapterProcess(pContext->pAdapter, pIn, pOut, n, indx);
+        in.used += n;
+        out.used += n;
+        done += n;
+        if (in.used == in.buffer.frameCount) {
+            Equalizer_streamRelease(&in);
+        }
+        if (out.used == out.buffer.frameCount) {
+            Equalizer_streamRelease(&out);
+        }
+    }
+    Equalizer_streamRelease(&in);
+    Equalizer_streamRelease(&out);
+    Equalizer_endBlock(pContext, &block, done);
 
-    return 0;
+    return status;
 }   // end Equalizer_process
 
+// Processes numTracks tracks of a planar stream in one call, for a mono
+// session: inBuffers[indx] and outBuffers[indx] are the buffers of track indx.
+// The result is the same as one Equalizer_process() per track, but the tracks
+// run side by side in vector lanes.
+extern int Equalizer_processPlanar(effect_handle_t self, audio_buffer_t inBuffers[], audio_buffer_t outBuffers[], int numTracks)
+{
+    EqualizerContext * pContext = (EqualizerContext *) self;
+    const void *pIn[MAX_CHANNELS];
+    void *pOut[MAX_CHANNELS];
+    int i = 0;
+    EqualizerBlock block;
+
+    if (pContext == NULL) {
+        return -EINVAL;
+    }
+    if (inBuffers == NULL || outBuffers == NULL || numTracks <= 0 || numTracks > MAX_CHANNELS) {
+        return -EINVAL;
+    }
+    for (i = 0; i < numTracks; ++i) {
+        if (inBuffers[i].raw == NULL || outBuffers[i].raw == NULL ||
+            inBuffers[i].frameCount != outBuffers[0].frameCount ||
+            outBuffers[i].frameCount != outBuffers[0].frameCount) {
+            return -EINVAL;
+        }
+        pIn[i] = inBuffers[i].raw;
+        pOut[i] = outBuffers[i].raw;
+    }
+
+    if (pContext->state == EQUALIZER_STATE_UNINITIALIZED) {
+        return -EINVAL;
+    }
+    if (pContext->config.outputCfg.channels != AUDIO_CHANNEL_OUT_MONO) {
+        // Each track of an interleaved session is one of its channels.
+        return -EINVAL;
+    }
+    if (pContext->state == EQUALIZER_STATE_INITIALIZED) {
+        return -ENODATA;
+    }
+    for (i = 0; i < numTracks; ++i) {
+        if (Equalizer_buffersOverlap(pContext, pIn[i], pOut[i], outBuffers[0].frameCount)) {
+            return -EINVAL;
+        }
+    }
+
+    Equalizer_beginBlock(pContext, &block);
+	AudioFormatAdapterProcessPlanar(pContext->pAdapter, pIn, pOut, outBuffers[0].frameCount, numTracks);
+    Equalizer_endBlock(pContext, &block, (size_t) outBuffers[0].frameCount * numTracks);
+
+    return 0;
+}   // end Equalizer_processPlanar
+
+// Returns true if the last block processed was silent, and the equalizer had
+// no tail left, so that it was skipped. Such a session keeps producing
+// silence for free, and can be scheduled with a low priority.
+extern bool Equalizer_isIdle(effect_handle_t self)
+{
+    EqualizerContext * pContext = (EqualizerContext *) self;
+
+    if (pContext == NULL || pContext->state != EQUALIZER_STATE_ACTIVE) {
+        return false;
+    }
+    return AudioFormatAdapterIsIdle(pContext->pAdapter);
+}   // end Equalizer_isIdle
+
+// Converts a mix bus, which sessions configured with
+// EFFECT_BUFFER_ACCESS_ACCUMULATE_WIDE have processed into, to the PCM format
+// of this session, with clipping. See AudioFormatAdapterNarrowBus().
+extern int Equalizer_narrowMixBus(effect_handle_t self, audio_buffer_t *busBuffer, audio_buffer_t *outBuffer)
+{
+    EqualizerContext * pContext = (EqualizerContext *) self;
+
+    if (pContext == NULL || pContext->state == EQUALIZER_STATE_UNINITIALIZED) {
+        return -EINVAL;
+    }
+    if (busBuffer == NULL || busBuffer->raw == NULL ||
+        outBuffer == NULL || outBuffer->raw == NULL ||
+        busBuffer->frameCount != outBuffer->frameCount) {
+        return -EINVAL;
+    }
+    if (pContext->config.outputCfg.accessMode != EFFECT_BUFFER_ACCESS_ACCUMULATE_WIDE) {
+        return -ENOSYS;
+    }
+
+    AudioFormatAdapterNarrowBus(pContext->pAdapter, busBuffer->raw, outBuffer->raw, outBuffer->frameCount);
+    Equalizer_count(&pContext->stats.clippedSamples, AudioFormatAdapterTakeNumClipped(pContext->pAdapter));
+
+    return 0;
+}   // end Equalizer_narrowMixBus
+
 extern int Equalizer_command(effect_handle_t self, uint32_t cmdCode, uint32_t cmdSize,
         void *pCmdData, uint32_t *replySize, void *pReplyData) {
 
@@ -674,9 +1290,40 @@ extern int Equalizer_command(effect_handle_t self, uint32_t cmdCode, uint32_t cm
             return -EINVAL;
         }
         p = (effect_param_t *) pCmdData;
-        *(int *)pReplyData = Equalizer_setParameter(pEqualizer, (int32_t *)p->data,
-                p->data + p->psize);
+        if (*(int32_t *)p->data == EQ_PARAM_NUM_BANDS) {
+            // Rebuilds the equalizer, which drops the staged parameters too.
+            *(int *)pReplyData = Equalizer_setNumBands(pContext, *(int32_t *)(p->data + p->psize));
+        } else {
+            *(int *)pReplyData = Equalizer_setParameter(pEqualizer, (int32_t *)p->data,
+                    p->data + p->psize, true);
+        }
+        // The parameters staged so far went with this commit. A rejected
+        // parameter commits nothing, and leaves them staged.
+        if (*(int *)pReplyData == 0) {
+            pContext->deferred = false;
+        }
         } break;
+    case EFFECT_CMD_SET_PARAM_DEFERRED: {
+        // Staged until EFFECT_CMD_SET_PARAM_COMMIT, so that a burst of
+        // parameters recomputes the coefficients once. There is no reply.
+        if (pCmdData == NULL || cmdSize < (sizeof(effect_param_t) + sizeof(int32_t))) {
+            return -EINVAL;
+        }
+        p = (effect_param_t *) pCmdData;
+        if (Equalizer_setParameter(pEqualizer, (int32_t *)p->data, p->data + p->psize, false) == 0) {
+            pContext->deferred = true;
+        }
+        } break;
+    case EFFECT_CMD_SET_PARAM_COMMIT:
+        if (pReplyData == NULL || *replySize != sizeof(int32_t)) {
+            return -EINVAL;
+        }
+        if (pContext->deferred) {
+            AudioEqualizerPublish(pEqualizer, true);
+            pContext->deferred = false;
+        }
+        *(int *)pReplyData = 0;
+        break;
     case EFFECT_CMD_ENABLE:
         if (pReplyData == NULL || *replySize != sizeof(int)) {
             return -EINVAL;
@@ -697,10 +1344,23 @@ extern int Equalizer_command(effect_handle_t self, uint32_t cmdCode, uint32_t cm
         pContext->state = EQUALIZER_STATE_INITIALIZED;
         *(int *)pReplyData = 0;
         break;
-    case EFFECT_CMD_SET_DEVICE:
     case EFFECT_CMD_SET_VOLUME:
+        if (pCmdData == NULL || cmdSize != 2 * sizeof(uint32_t)) {
+            return -EINVAL;
+        }
+        if (pReplyData != NULL && (replySize == NULL || *replySize < 2 * sizeof(uint32_t))) {
+            return -EINVAL;
+        }
+        return Equalizer_setVolume(pContext, (const uint32_t *) pCmdData, (uint32_t *) pReplyData);
+    case EFFECT_CMD_SET_DEVICE:
     case EFFECT_CMD_SET_AUDIO_MODE:
         break;
+    case EQ_CMD_GET_STATS:
+        if (pReplyData == NULL || *replySize != sizeof(equalizer_stats_t)) {
+            return -EINVAL;
+        }
+        Equalizer_getStats(pContext, (equalizer_stats_t *) pReplyData);
+        break;
     default:
         return -EINVAL;
     }
@@ -721,6 +1381,106 @@ extern int Equalizer_getDescriptor(effect_handle_t   self, effect_descriptor_t *
     return 0;
 }
 
+//
+//--- In-process control interface
+//
+// Typed counterparts of the parameter commands, for a host that has the
+// effect in its own process: the values go straight to the equalizer, with
+// no effect_param_t to pack and parse, and no shared buffer, so instances can
+// be controlled concurrently. The calls on one instance are serialized by the
+// caller, like its commands, with which they can be mixed. Each setter
+// commits like EFFECT_CMD_SET_PARAM, along with the parameters staged by
+// EFFECT_CMD_SET_PARAM_DEFERRED, if any.
+
+// Returns the number of bands of the instance, or -EINVAL.
+extern int32_t Equalizer_getNumBands(effect_handle_t self)
+{
+    EqualizerContext * pContext = (EqualizerContext *) self;
+
+    if (pContext == NULL || pContext->state == EQUALIZER_STATE_UNINITIALIZED) {
+        return -EINVAL;
+    }
+    return AudioEqualizerGetNumBands(pContext->pEqualizer);
+}   // end Equalizer_getNumBands
+
+// Sets the gains (in millibels), center frequencies (in millihertz) and
+// bandwidths (in cents) of the numBands bands, which must be the number of
+// bands of the instance, in a single commit. A NULL array leaves its
+// property as it is. Same as EQ_PARAM_PROPERTIES with the custom preset.
+extern int Equalizer_setBandProperties(effect_handle_t self, int32_t numBands,
+        const int32_t *pGains, const int32_t *pFreqs, const int32_t *pBandwidths)
+{
+    EqualizerContext * pContext = (EqualizerContext *) self;
+
+    if (pContext == NULL || pContext->state == EQUALIZER_STATE_UNINITIALIZED) {
+        return -EINVAL;
+    }
+    if (numBands != AudioEqualizerGetNumBands(pContext->pEqualizer)) {
+        return -EINVAL;
+    }
+    Equalizer_setBands(pContext->pEqualizer, pGains, pFreqs, pBandwidths);
+    AudioEqualizerPublish(pContext->pEqualizer, true);
+    pContext->deferred = false;
+
+    return 0;
+}   // end Equalizer_setBandProperties
+
+// Applies a preset, from 0 to the number of presets (EQ_PARAM_GET_NUM_OF_PRESETS)
+// minus 1. Same as EQ_PARAM_CUR_PRESET.
+extern int Equalizer_setPreset(effect_handle_t self, int32_t preset)
+{
+    EqualizerContext * pContext = (EqualizerContext *) self;
+
+    if (pContext == NULL || pContext->state == EQUALIZER_STATE_UNINITIALIZED) {
+        return -EINVAL;
+    }
+    if (preset < 0 || preset >= AudioEqualizerGetNumPresets(pContext->pEqualizer)) {
+        return -EINVAL;
+    }
+    AudioEqualizerSetPreset(pContext->pEqualizer, preset);
+    AudioEqualizerPublish(pContext->pEqualizer, true);
+    pContext->deferred = false;
+
+    return 0;
+}   // end Equalizer_setPreset
+
+// Gets the current preset (PRESET_CUSTOM once a band was set), and the gains,
+// center frequencies and bandwidths of the numBands bands, which must be the
+// number of bands of the instance, in the units of
+// Equalizer_setBandProperties(). Any of the pointers may be NULL. The values
+// are those last set, committed or not.
+extern int Equalizer_getProperties(effect_handle_t self, int32_t numBands, int32_t *pPreset,
+        int32_t *pGains, int32_t *pFreqs, int32_t *pBandwidths)
+{
+    EqualizerContext * pContext = (EqualizerContext *) self;
+    AUDIO_EQUALIZER * pEqualizer = NULL;
+    int i = 0;
+
+    if (pContext == NULL || pContext->state == EQUALIZER_STATE_UNINITIALIZED) {
+        return -EINVAL;
+    }
+    pEqualizer = pContext->pEqualizer;
+    if (numBands != AudioEqualizerGetNumBands(pEqualizer)) {
+        return -EINVAL;
+    }
+    if (pPreset != NULL) {
+        *pPreset = AudioEqualizerGetPreset(pEqualizer);
+    }
+    for (i = 0; i < numBands; i++) {
+        if (pGains != NULL) {
+            pGains[i] = AudioEqualizerGetGain(pEqualizer, i);
+        }
+        if (pFreqs != NULL) {
+            pFreqs[i] = (int32_t) AudioEqualizerGetFrequency(pEqualizer, i);
+        }
+        if (pBandwidths != NULL) {
+            pBandwidths[i] = (int32_t) AudioEqualizerGetBandwidth(pEqualizer, i);
+        }
+    }
+
+    return 0;
+}   // end Equalizer_getProperties
+
 
 extern void EffectSetCmdEnable(effect_handle_t pEQHandle, bool flag)
 {    
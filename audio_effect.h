@@ -34,6 +34,7 @@ typedef struct effect_uuid_s {
 // Maximum length of character strings in structures defines by this API.
 #define EFFECT_STRING_LEN_MAX 64
 
+// Default number of bands of an equalizer instance, the one of the presets.
 #define kNumBands  (5)
 
 // NULL UUID definition (matches SL_IID_NULL_)
@@ -59,7 +60,13 @@ typedef struct effect_descriptor_s {
 
 typedef struct _audio_buffer_t_ {
     size_t   frameCount;        // number of frames in buffer
-    int16_t*    s16;        // pointer to signed 16 bit data at start of buffer
+    union {
+        void*       raw;        // raw pointer to start of buffer
+        float*      f32;        // pointer to float 32 bit data at start of buffer
+        int32_t*    s32;        // pointer to signed 32 bit data at start of buffer
+        int16_t*    s16;        // pointer to signed 16 bit data at start of buffer
+        uint8_t*    u8;         // pointer to unsigned 8 bit data at start of buffer
+    };
 }audio_buffer_t;
 
 typedef enum _effect_sound_track_ {
@@ -96,6 +103,35 @@ typedef enum _effect_command_e_ {
    EFFECT_CMD_FIRST_PROPRIETARY = 0x10000 // first proprietary command code
 }effect_command_e;
 
+// Proprietary commands of the equalizer.
+enum equalizer_command_e {
+   // Reads the statistics of the instance. No command data; the reply is an
+   // equalizer_stats_t.
+   EQ_CMD_GET_STATS = EFFECT_CMD_FIRST_PROPRIETARY
+};
+
+// Statistics of an equalizer instance, returned by EQ_CMD_GET_STATS. The
+// counters start at 0 when the equalizer is initialized (EffectCreate(),
+// EFFECT_CMD_INIT, or a change of EQ_PARAM_NUM_BANDS), and only go up; the
+// client computes rates from the difference of two snapshots. A snapshot taken
+// while a block is processed may be a block behind on some of them.
+typedef struct equalizer_stats_s {
+    uint64_t    processCalls;       // blocks processed (Equalizer_process() and
+                                    // Equalizer_processPlanar() calls that did so)
+    uint64_t    framesProcessed;    // frames processed, of all the tracks
+    uint64_t    processNs;          // time spent processing, in nanoseconds
+    uint64_t    maxProcessNs;       // longest time spent on a block
+    uint64_t    transitionCalls;    // blocks that started in a coefficient transition
+    uint64_t    transitionNs;       // time spent on those blocks; the rest of
+                                    // processNs went to steady blocks
+    uint64_t    sections;           // bands, summed over the blocks
+    uint64_t    bypassedSections;   // bands that were bypassed, summed over the blocks
+    uint64_t    clippedSamples;     // 16 bit output samples clipped
+    uint64_t    commits;            // settings published by the control thread
+    uint64_t    appliedCommits;     // settings picked up by the audio thread; the
+                                    // others were replaced before that
+} equalizer_stats_t;
+
 typedef enum _EFFECT_EQ_TYPE_ {
     CUSTOMER_TYPE = 0,//customer
 	CLASSIC_TYPE,//Classic
@@ -105,11 +141,13 @@ typedef enum _EFFECT_EQ_TYPE_ {
 }EFFECT_EQ_TYPE;
 
 // Values for "accessMode" field of buffer_config_t:
-//   overwrite, read only, accumulate (read/modify/write)
+//   overwrite, read only, accumulate (read/modify/write), accumulate into a
+//   wide mix bus (see Equalizer_narrowMixBus())
 enum effect_buffer_access_e {
     EFFECT_BUFFER_ACCESS_WRITE,
     EFFECT_BUFFER_ACCESS_READ,
-    EFFECT_BUFFER_ACCESS_ACCUMULATE
+    EFFECT_BUFFER_ACCESS_ACCUMULATE,
+    EFFECT_BUFFER_ACCESS_ACCUMULATE_WIDE
 };
 
 // feature identifiers for EFFECT_CMD_GET_FEATURE_SUPPORTED_CONFIGS command
@@ -199,5 +237,13 @@ typedef struct effect_param_s {
 #define EFFECT_FLAG_INSERT_LAST         (2 << EFFECT_FLAG_INSERT_SHIFT)
 #define EFFECT_FLAG_INSERT_EXCLUSIVE    (3 << EFFECT_FLAG_INSERT_SHIFT)
 
+// Volume control
+#define EFFECT_FLAG_VOLUME_SHIFT        (EFFECT_FLAG_INSERT_SHIFT + EFFECT_FLAG_INSERT_SIZE)
+#define EFFECT_FLAG_VOLUME_SIZE         3
+#define EFFECT_FLAG_VOLUME_MASK         (((1 << EFFECT_FLAG_VOLUME_SIZE) -1) << EFFECT_FLAG_VOLUME_SHIFT)
+#define EFFECT_FLAG_VOLUME_CTRL         (1 << EFFECT_FLAG_VOLUME_SHIFT)
+#define EFFECT_FLAG_VOLUME_IND          (2 << EFFECT_FLAG_VOLUME_SHIFT)
+#define EFFECT_FLAG_VOLUME_NONE         (0 << EFFECT_FLAG_VOLUME_SHIFT)
+
 
 #endif  
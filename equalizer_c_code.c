@@ -45,6 +45,16 @@ extern void EffectSetCmdConfig(effect_handle_t pEQHandle);
 
 extern void EffectGetParam(effect_handle_t pEQHandle, int32_t indx);
 
+extern int32_t Equalizer_getNumBands(effect_handle_t self);
+
+extern int Equalizer_setBandProperties(effect_handle_t self, int32_t numBands,
+                                       const int32_t *pGains, const int32_t *pFreqs, const int32_t *pBandwidths);
+
+extern int Equalizer_setPreset(effect_handle_t self, int32_t preset);
+
+extern int Equalizer_getProperties(effect_handle_t self, int32_t numBands, int32_t *pPreset,
+                                   int32_t *pGains, int32_t *pFreqs, int32_t *pBandwidths);
+
 
 
 int main(int argc, char* argv[])
@@ -86,6 +96,8 @@ int main(int argc, char* argv[])
     ///EffectSetCmdBandLevel(pEQHandle, bandIndx, gainValue);///set param cmd
     //printf("set_EQ_CMD set properties \n");
     ///EffectSetCmdProperties(pEQHandle, CUSTOMER_TYPE, gGainData, gFreqData, gbandwidthData);
+    ///Same without the command marshalling, for a host in the same process:
+    ///Equalizer_setBandProperties(pEQHandle, kNumBands, gGainData, gFreqData, gbandwidthData);
 
     ///printf("set_EQ_CONFIG start set config \n");
     ///EffectSetCmdConfig(pEQHandle);///set config